@@ -4,6 +4,7 @@
 
 #include "types.h"
 #include "Token.h"
+#include "HashMap.h"
 
 #include "AST/Kind.h"
 #include "AST/Base.h"
@@ -11,6 +12,7 @@
 #include "AST/Stmt.h"
 #include "AST/Types.h"
 #include "AST/Function.h"
+#include "AST/Arena.h"
 
 namespace fire::AST {
 
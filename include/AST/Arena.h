@@ -0,0 +1,74 @@
+#pragma once
+
+namespace fire::AST {
+
+//
+// Arena
+//
+//  AST nodes are bump-allocated from the arena of current thread, in order of
+//  creation, and are destroyed together when the arena is destroyed.
+//  links between nodes are raw pointers, so nodes don't own each other.
+//
+//  an arena is made for each script (see execute_file in main.cpp), and
+//  lives until evaluation of the script is done.
+//
+class Arena {
+public:
+  // makes this arena current on this thread until destroyed.
+  struct Scope {
+    Arena* prev;
+
+    explicit Scope(Arena& arena);
+    ~Scope();
+  };
+
+  Arena() = default;
+  ~Arena();
+
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  template <class T, class... Args>
+  T* New(Args&&... args) {
+    auto node = new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+
+    this->nodes.emplace_back(node);
+
+    return node;
+  }
+
+  size_t size() const {
+    return this->nodes.size();
+  }
+
+  // all nodes in order of creation.
+  vector<Base*> const& get_nodes() const {
+    return this->nodes;
+  }
+
+  // p is in memory of this arena.
+  bool contains(void const* p) const;
+
+  // arena of this thread. (or global one, if no scope)
+  static Arena& current();
+
+private:
+  static constexpr size_t ChunkSize = 64 * 1024;
+
+  void* allocate(size_t size, size_t align);
+
+  struct Chunk {
+    char* begin;
+    char* end;
+  };
+
+  vector<Chunk> chunks;
+
+  char* ptr = nullptr;
+  char* end = nullptr;
+
+  // to call destructors
+  vector<Base*> nodes;
+};
+
+} // namespace fire::AST
@@ -27,8 +27,11 @@ struct Identifier : Named {
   ASTVec<Function> candidates;
   vector<builtins::Function const*> candidates_builtin;
 
-  TypeInfo ft_ret;
-  vector<TypeInfo> ft_args;
+  TypeId ft_ret;
+  vector<TypeId> ft_args;
+
+  // function type made of ft_ret and ft_args.
+  TypeInfo get_ft_type() const;
 
   vector<TypeInfo> template_args;
 
@@ -83,6 +86,30 @@ struct Array : Base {
   Array(Token tok);
 };
 
+struct Tuple : Base {
+  ASTVector elements;
+
+  TypeInfo type; // set in Sema
+
+  static ASTPtr<Tuple> New(Token tok);
+
+  ASTPointer Clone() const override;
+
+  Tuple(Token tok);
+};
+
+struct Dict : Base {
+  Vec<std::pair<ASTPointer, ASTPointer>> elements; // key, value
+
+  TypeInfo type; // set in Sema
+
+  static ASTPtr<Dict> New(Token tok);
+
+  ASTPointer Clone() const override;
+
+  Dict(Token tok);
+};
+
 struct CallFunc : Base {
   ASTPointer callee; // left side, evaluated to be callable object.
   ASTVector args;
@@ -109,6 +136,9 @@ struct Expr : Base {
   ASTPointer lhs;
   ASTPointer rhs;
 
+  // vector + vector is concatenation, not append. (set by Sema)
+  bool is_concat = false;
+
   static ASTPtr<Expr> New(ASTKind kind, Token optok, ASTPointer lhs, ASTPointer rhs);
 
   ASTPointer Clone() const override;
@@ -19,6 +19,12 @@ struct Function : Templatable {
 
   bool is_var_arg;
 
+  // return_type is future<T>. (see Parser::Top)
+  bool is_async = false;
+
+  // has yield statement, return_type is generator<T>. (set by Sema)
+  bool is_generator = false;
+
   ASTPtr<Class> member_of = nullptr;
 
   static ASTPtr<Function> New(Token tok, Token name);
@@ -25,6 +25,8 @@ enum class ASTKind {
   OverloadResolutionGuide, // "of"
 
   Array,
+  Tuple,
+  Dict,
 
   IndexRef,
 
@@ -47,6 +49,8 @@ enum class ASTKind {
 
   Not, // => todo impl.
 
+  Await, // lhs = future
+
   Mul,
   Div,
   Mod,
@@ -83,11 +87,14 @@ enum class ASTKind {
 
   Switch,
   While,
+  ForEach,
+  ParallelFor,
 
   Break,
   Continue,
 
   Return,
+  Yield,
 
   Throw,
   TryCatch,
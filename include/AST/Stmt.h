@@ -17,6 +17,9 @@ struct VarDef : Named {
   ASTPtr<TypeName> type;
   ASTPointer init;
 
+  // let (a, b) = tuple;
+  ASTVec<VarDef> unpack;
+
   int index = 0;
   int index_add = 0;
 
@@ -52,6 +55,41 @@ struct Statement : Base {
     ASTPtr<Block> block;
   };
 
+  //
+  // for <varname> in <iterable> { }
+  struct ForEach {
+    Token varname;
+    ASTPointer iterable;
+    ASTPtr<Block> block;
+
+    TypeInfo _elem_type; // set in Sema
+  };
+
+  //
+  // parallel for <varname> in <begin> .. <end> [reduce(<op>) into <acc>] { }
+  //  iterations run on threads. (see Evaluator::parallel_for)
+  struct ParallelFor {
+    Token varname;
+    ASTPointer begin = nullptr, end = nullptr;
+    ASTPtr<Block> block = nullptr;
+
+    // reduction (acc is null if not used)
+    ASTKind op = ASTKind::Add; // Add or Mul
+    ASTPointer acc = nullptr;
+
+    TypeInfo _acc_type = {}; // set in Sema
+
+    // vectors declared out of the body and used in it. (set in Sema)
+    // to find aliases of vectors written as v[i], see ParallelChecker.
+    struct OuterVector {
+      string_view name;
+      TypeInfo type;
+      ASTPtr<VarDef> decl; // null if argument
+    };
+
+    vector<OuterVector> _outer_vectors = {};
+  };
+
   struct TryCatch {
     struct Catcher {
       Token varname; // name of variable to catch exception instance
@@ -70,6 +108,8 @@ struct Statement : Base {
     If* data_if;
     Switch* data_switch;
     While* data_while;
+    ForEach* data_for_each;
+    ParallelFor* data_parallel_for;
     TryCatch* data_try_catch;
 
     void* _data = nullptr;
@@ -85,6 +125,14 @@ struct Statement : Base {
 
   static ASTPtr<Statement> NewWhile(Token tok, ASTPointer cond, ASTPtr<Block> block);
 
+  static ASTPtr<Statement> NewForEach(Token tok, Token varname, ASTPointer iterable,
+                                      ASTPtr<Block> block);
+
+  static ASTPtr<Statement> NewParallelFor(Token tok, Token varname, ASTPointer begin,
+                                          ASTPointer end, ASTPtr<Block> block,
+                                          ASTKind op = ASTKind::Add,
+                                          ASTPointer acc = nullptr);
+
   static ASTPtr<Statement> NewTryCatch(Token tok, ASTPtr<Block> tryblock,
                                        vector<TryCatch::Catcher> catchers);
 
@@ -146,6 +194,40 @@ struct Match : Base {
   ASTPointer cond;
   Vec<Pattern> patterns;
 
+  //
+  // decision tree  (built in Sema)
+  //
+  //  Linear      = test each pattern in order
+  //  Enumerator  = candidates by index of enumerator
+  //  Table       = jump table by int, char or bool value
+  //  Hash        = hashed by constant value (string or sparse int)
+  //
+  enum class Dispatch : u8 {
+    Linear,
+    Enumerator,
+    Table,
+    Hash,
+  };
+
+  struct KeyHash {
+    size_t operator()(ObjPointer const& key) const;
+  };
+
+  struct KeyEqual {
+    bool operator()(ObjPointer const& a, ObjPointer const& b) const;
+  };
+
+  Dispatch dispatch = Dispatch::Linear;
+
+  i64 table_base = 0;
+  Vec<i32> table; // value - table_base => index of pattern (-1 = none)
+
+  Vec<Vec<u32>> enum_table; // index of enumerator => candidates
+
+  HashMap<ObjPointer, u32, KeyHash, KeyEqual> hash;
+
+  i32 fallback = -1; // "_" or variable
+
   static ASTPtr<Match> New(Token tok, ASTPointer cond, Vec<Pattern> patterns);
 
   ASTPointer Clone() const override;
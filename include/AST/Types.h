@@ -5,7 +5,7 @@
 namespace fire::AST {
 
 struct TypeName : Named {
-  ASTPtr<Signature> sig;
+  ASTPtr<Signature> sig = nullptr;
 
   ASTVec<TypeName> type_params;
   bool is_const;
@@ -54,6 +54,9 @@ struct Enum : Templatable {
 
   vector<Enumerator> enumerators;
 
+  // type of ObjEnumerator
+  TypeId enumerator_type;
+
   template <typename... Args>
   requires std::constructible_from<Enumerator, Args...>
   Enumerator& append(Args&&... args) {
@@ -71,6 +74,23 @@ struct Class : Templatable {
   ASTVec<VarDef> member_variables;
   ASTVec<Function> member_functions;
 
+  //
+  // layout of member variables in instance  (set in Sema)
+  //
+  //  int, float, bool and char are stored as raw value,
+  //  others are stored as ObjPointer.
+  //
+  struct Field {
+    TypeKind kind = TypeKind::None; // None = not raw value
+    size_t offset = 0;
+  };
+
+  vector<Field> layout;
+  size_t fields_size = 0;
+
+  // type of ObjInstance
+  TypeId instance_type;
+
   static ASTPtr<Class> New(Token tok, Token name);
 
   static ASTPtr<Class> New(Token tok, Token name, ASTVec<VarDef> member_variables,
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <new>
+
+#include "types.h"
+
+namespace fire::alloc {
+
+//
+// pool allocator for objects
+//
+//  Object::operator new / delete come here, so every ObjNew and ObjInstance::New
+//  is served from free list of size class, instead of malloc.
+//
+//  sizes are rounded up to Granularity. blocks larger than MaxSize go to
+//  global operator new.
+//
+//  each thread has own pool. (no lock)
+//  slabs are never returned to system, so a block freed by other thread
+//  is simply reused by that thread.
+//  free blocks of finished thread are given to next thread. (see release_thread)
+//
+
+constexpr size_t Granularity = 16;
+constexpr size_t MaxSize = 256;
+constexpr size_t ClassCount = MaxSize / Granularity;
+
+constexpr size_t SlabSize = 64 * 1024;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct SizeClass {
+  FreeBlock* free_list = nullptr;
+
+  size_t allocated = 0; // count of allocate()
+  size_t freed = 0;     // count of deallocate()
+  size_t slabs = 0;
+};
+
+struct Pool {
+  SizeClass classes[ClassCount];
+
+  // blocks larger than MaxSize
+  size_t large_allocated = 0;
+  size_t large_freed = 0;
+};
+
+extern thread_local Pool pool;
+
+// take free blocks of finished thread, or carve new slab into free list of sc.
+// return = one block
+void* refill(SizeClass& sc, size_t block_size);
+
+// give free blocks of this thread to others. (before exit of thread)
+void release_thread();
+
+inline size_t class_index(size_t size) {
+  return (size - 1) / Granularity;
+}
+
+inline void* allocate(size_t size) {
+  if (size > MaxSize) {
+    pool.large_allocated++;
+    return ::operator new(size);
+  }
+
+  auto index = class_index(size);
+  auto& sc = pool.classes[index];
+
+  sc.allocated++;
+
+  if (auto block = sc.free_list; block) {
+    sc.free_list = block->next;
+    return block;
+  }
+
+  return refill(sc, (index + 1) * Granularity);
+}
+
+inline void deallocate(void* p, size_t size) {
+  if (size > MaxSize) {
+    pool.large_freed++;
+    return ::operator delete(p);
+  }
+
+  auto& sc = pool.classes[class_index(size)];
+  auto block = static_cast<FreeBlock*>(p);
+
+  sc.freed++;
+
+  block->next = sc.free_list;
+  sc.free_list = block;
+}
+
+void print_stats();
+
+} // namespace fire::alloc
@@ -42,6 +42,9 @@ struct MemberVariable {
 
 Function const* find_builtin_func(std::string const& name);
 
+// all overloads of name, or null if no builtin function has the name.
+vector<Function const*> const* find_builtin_funcs(string_view name);
+
 vector<Function> const& get_builtin_functions();
 
 vector<std::pair<TypeInfo, Function>> const& get_builtin_member_functions();
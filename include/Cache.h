@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+
+#include "types.h"
+
+namespace fire {
+
+//
+// ProgramCache
+//
+//  tokens and AST of a script checked by Sema are saved to a file, and
+//  are loaded from it on next run of same script instead of lexing,
+//  parsing and Sema.
+//
+//  name of the file is hash of contents of the script, version of fire and
+//  the executable of interpreter. so it is not used after any of them is
+//  changed.  ($XDG_CACHE_HOME/fire/<hash>.firec or ~/.cache/fire/<hash>.firec)
+//
+//  the file is mapped by mmap. strings of tokens which are not in source
+//  point to the mapping, so this lives until the script is done.
+//
+class ProgramCache {
+public:
+  explicit ProgramCache(SourceStorage& source);
+  ~ProgramCache();
+
+  ProgramCache(ProgramCache const&) = delete;
+  ProgramCache& operator=(ProgramCache const&) = delete;
+
+  // makes nodes in current arena, and tokens in source.
+  // returns null if not cached or the file is broken.
+  ASTPtr<AST::Block> Load();
+
+  // saves all nodes in current arena. (root is one of them)
+  // returns false if AST has something which cannot be saved.
+  bool Save(ASTPtr<AST::Block> root);
+
+  std::string const& GetPath();
+
+private:
+  SourceStorage& source;
+
+  std::string path;
+
+  // hash of source and interpreter (see GetPath)
+  u64 key[2] = {};
+
+  void* mapped = nullptr;
+  size_t mapped_size = 0;
+};
+
+} // namespace fire
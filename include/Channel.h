@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "types.h"
+
+namespace fire {
+
+//
+// Channel
+//
+//  queue of objects between threads. (see ObjChannel)
+//
+//  bounded channel is lock-free MPMC ring buffer:
+//  each cell has sequence number, cell at pos is ready to push when
+//  seq == pos, and ready to pop when seq == pos + 1.
+//  capacity is rounded up to power of 2.
+//
+//  unbounded channel (capacity 0) is a deque guarded by mutex.
+//
+//  send / recv wait on pushed / popped counters (atomic wait) when
+//  channel is full / empty.
+//
+//  objects in channel are detached from gc of any thread.
+//
+class Channel {
+public:
+  explicit Channel(size_t capacity);
+  ~Channel();
+
+  Channel(Channel const&) = delete;
+  Channel& operator=(Channel const&) = delete;
+
+  // return false if closed. (obj is not moved)
+  bool Send(ObjPointer& obj);
+
+  // wait for object.
+  // return = null if closed and empty.
+  ObjPointer Recv();
+
+  void Close();
+
+  bool is_closed() const {
+    return this->closed.load(std::memory_order_acquire);
+  }
+
+  size_t capacity() const {
+    return this->cells ? this->mask + 1 : 0;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    ObjPointer value;
+  };
+
+  bool try_push(ObjPointer& obj);
+  bool try_pop(ObjPointer& out);
+
+  // bounded
+  Cell* cells = nullptr;
+  size_t mask = 0;
+
+  alignas(64) std::atomic<size_t> enqueue_pos{0};
+  alignas(64) std::atomic<size_t> dequeue_pos{0};
+
+  // unbounded
+  std::mutex mtx;
+  std::deque<ObjPointer> queue;
+
+  // changed after each push / pop, or close. (for waiting)
+  alignas(64) std::atomic<u32> pushed{0};
+  alignas(64) std::atomic<u32> popped{0};
+
+  std::atomic<bool> closed{false};
+};
+
+// obj or its copy which can be given to other thread. (detached from gc)
+// obj is moved without copy when nothing else refers to it.
+ObjPointer make_sendable(ObjPointer obj);
+
+} // namespace fire
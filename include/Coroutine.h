@@ -0,0 +1,86 @@
+#pragma once
+
+#include <functional>
+#include <exception>
+#include <ucontext.h>
+
+#include "types.h"
+
+namespace fire {
+
+//
+// Coroutine
+//
+//  runs body on own stack (allocated by mmap, not on native stack of caller),
+//  so the evaluator can suspend a call in the middle of recursion, and
+//  resume it later. (used by async functions and generators)
+//
+//  Resume() runs body until Suspend() or end of body.
+//  exception thrown from body is thrown again from Resume().
+//
+//  destroying a suspended coroutine throws Cancel from Suspend(),
+//  so objects on its stack are freed by unwinding.
+//
+class Coroutine {
+public:
+  struct Cancel {};
+
+  static constexpr size_t StackSize = 8 * 1024 * 1024;
+
+  explicit Coroutine(std::function<void()> body);
+  ~Coroutine();
+
+  Coroutine(Coroutine const&) = delete;
+  Coroutine& operator=(Coroutine const&) = delete;
+
+  void Resume();
+
+  // back to caller of Resume(). (only in body)
+  static void Suspend();
+
+  // running coroutine, or null if not in any coroutine.
+  static Coroutine* Current();
+
+  bool is_done() const {
+    return this->done;
+  }
+
+private:
+  // saved registers of suspended side.
+  //  x86-64 uses own switch which saves only callee-saved registers,
+  //  swapcontext also saves signal mask by system call.
+  struct Context {
+#if defined(__x86_64__)
+    void* sp = nullptr;
+#else
+    ucontext_t uc;
+#endif
+  };
+
+  static void entry();
+
+  static void init_context(Context& ctx, void* stack, size_t size);
+  static void switch_context(Context& from, Context& to);
+
+  std::function<void()> body;
+
+  Context context;
+  Context caller;
+
+  void* stack = nullptr;
+
+  // for asan (see start_switch)
+  void* fake_stack = nullptr;
+  void const* caller_bottom = nullptr;
+  size_t caller_size = 0;
+
+  Coroutine* prev = nullptr;
+
+  bool started = false;
+  bool done = false;
+  bool canceled = false;
+
+  std::exception_ptr error = nullptr;
+};
+
+} // namespace fire
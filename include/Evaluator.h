@@ -4,6 +4,7 @@
 
 #include "AST.h"
 #include "Object.h"
+#include "Coroutine.h"
 
 namespace fire::eval {
 
@@ -20,9 +21,68 @@ public:
 
   ObjPointer& eval_as_left(ASTPointer ast);
 
-  ObjPointer& eval_index_ref(ObjPointer array, ObjPointer index);
+  ObjPointer& eval_index_ref(ASTPtr<AST::Expr> ast, ObjPointer array, ObjPointer index);
+
+  //
+  // left side of member access. (a of a.x)
+  // v[i] of columnar vector returns the vector and row = i, without making
+  // reference to the row. (row = -1 for others)
+  //
+  ObjPointer eval_member_owner(ASTPointer ast, i64& row);
+
+  //
+  // call user-defined function with evaluated arguments.
+  // (used from builtin functions to call callable object)
+  //
+  ObjPointer call_function(ASTPtr<AST::Function> func, ObjVector args,
+                           ASTPointer loc = nullptr);
+
+  //
+  // run callable on new thread with own evaluator.
+  //
+  //  the thread does not share objects with this:
+  //  callable, args and global variables are deep-copied.
+  //
+  ObjPtr<ObjThread> spawn(ObjPtr<ObjCallable> callable, ObjVector args,
+                          ASTPtr<AST::CallFunc> ast);
+
+  //
+  // call async function.
+  //
+  //  the call runs as a task on event loop of this thread. (see EventLoop)
+  //  frames of task are on own coroutine stack, so await in the task
+  //  suspends it and lets other tasks run.
+  //
+  ObjPtr<ObjFuture> call_async(ASTPtr<AST::Function> func, ObjVector args,
+                               ASTPointer loc);
+
+  //
+  // wait for result of future.
+  //
+  //  in a task, suspend the task until future is done.
+  //  otherwise run event loop until future is done.
+  //
+  ObjPointer await(ObjPtr<ObjFuture> future, ASTPointer loc);
+
+  //
+  // call generator function. (function which has yield)
+  //
+  //  body runs on own coroutine, from each next() until yield.
+  //
+  ObjPtr<ObjGenerator> make_generator(ASTPtr<AST::Function> func, ObjVector args,
+                                      ASTPointer loc);
+
+  // resume generator until next yield.
+  // return = false if generator is finished.
+  bool next(ObjPtr<ObjGenerator> gen, ObjPointer& out);
+
+  static Evaluator* GetInstance();
 
 private:
+  friend struct GeneratorState;
+
+  struct Task;
+
   struct VarStack {
     vector<ObjPointer> var_list;
 
@@ -39,6 +99,9 @@ private:
 
   using VarStackPtr = std::shared_ptr<VarStack>;
 
+  bool eval_match_arm(AST::Match::Pattern const& P, ObjPointer const& cond,
+                      bool is_equal);
+
   VarStackPtr push_stack(size_t var_count);
   void pop_stack();
 
@@ -50,7 +113,49 @@ private:
   std::list<VarStackPtr> call_stack;
   std::list<VarStackPtr> loops;
 
-  static ObjPtr<ObjNone> _None;
+  //
+  // call running on own coroutine. (async task or generator)
+  //  frames are swapped with frames of evaluator while running. (see resume)
+  //
+  struct Fiber {
+    std::unique_ptr<Coroutine> co;
+
+    std::list<VarStackPtr> var_stack;
+    std::list<VarStackPtr> call_stack;
+    std::list<VarStackPtr> loops;
+  };
+
+  // exception from coroutine is thrown again after frames are restored.
+  void resume(Fiber& fiber);
+
+  ObjPointer run_function(ASTPtr<AST::Function> func, ObjVector args, ASTPointer loc);
+
+  void resume_task(std::shared_ptr<Task> task);
+
+  // running task. (see call_async)
+  Task* cur_task = nullptr;
+
+  // running generator. (see next)
+  GeneratorState* cur_generator = nullptr;
+
+  // give value to next(), and wait for next call of it.
+  void yield(ObjPointer value);
+
+  //
+  // parallel for statement.
+  //
+  //  iterations are divided into chunks, and threads take them in order.
+  //  objects reachable from frames are frozen while the loop runs, so threads
+  //  can refer to them at same time. (see gc::freeze)
+  //  each thread runs own evaluator, and shares frames of this. (Sema checks
+  //  that body does not write to them)
+  //
+  void parallel_for(ASTPtr<AST::Statement> ast);
+
+  // evaluator of spawned thread. (see spawn)
+  bool is_isolate = false;
+
+  ObjPtr<ObjNone> _None;
 };
 
 } // namespace fire::eval
\ No newline at end of file
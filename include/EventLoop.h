@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "types.h"
+
+namespace fire::io {
+
+//
+// EventLoop
+//
+//  runs callbacks of ready tasks, expired timers and fd events. (epoll)
+//
+//  regular files cannot be waited by epoll, so file I/O runs on worker
+//  threads (see run_in_worker), and completion is sent back to the loop
+//  through eventfd. callbacks always run on the thread of the loop.
+//
+//  each thread has own loop. (see get)
+//
+class EventLoop {
+public:
+  using Callback = std::function<void()>;
+  using Clock = std::chrono::steady_clock;
+
+  EventLoop();
+  ~EventLoop();
+
+  EventLoop(EventLoop const&) = delete;
+  EventLoop& operator=(EventLoop const&) = delete;
+
+  // run cb in next run_once().
+  void post(Callback cb);
+
+  void add_timer(i64 ms, Callback cb);
+
+  // cb is called each time fd is ready, until unwatch(fd).
+  void watch(int fd, u32 events, Callback cb);
+  void unwatch(int fd);
+
+  // run work on worker thread, and then done on this loop.
+  // work must not touch objects. (they are owned by this thread)
+  void run_in_worker(Callback work, Callback done);
+
+  // run ready callbacks, or wait for next event.
+  // return = false if nothing to wait for.
+  bool run_once();
+
+  // drop all callbacks, after jobs on workers are finished.
+  // (tasks waiting for them are destroyed, and watched fds are closed)
+  void cancel_all();
+
+  static EventLoop& get();
+
+private:
+  friend struct WorkerPool;
+
+  void wait_events(int timeout_ms);
+
+  // called by worker.
+  void complete(Callback done);
+
+  int epoll_fd;
+  int event_fd; // signaled by workers
+
+  std::deque<Callback> ready;
+
+  std::multimap<Clock::time_point, Callback> timers;
+
+  std::unordered_map<int, Callback> watchers;
+
+  // done callbacks from workers
+  std::mutex mtx;
+  vector<Callback> completed;
+
+  size_t running_jobs = 0;
+};
+
+//
+// FutureState
+//
+//  result of async call or async I/O. (see ObjFuture)
+//  used only on one thread. (Sema rejects future in spawn() and channel<T>)
+//
+struct FutureState {
+  bool done = false;
+
+  ObjPointer result = nullptr;
+  std::exception_ptr error = nullptr;
+
+  // posted to loop when done
+  vector<EventLoop::Callback> waiters;
+
+  void resolve(ObjPointer obj);
+  void reject(std::exception_ptr e);
+};
+
+} // namespace fire::io
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "types.h"
+
+namespace fire::gc {
+
+//
+// cycle collector
+//
+//  objects are owned by reference counting (ObjPointer, see ObjRef).
+//  collector finds cycles of container objects (vector, dict, tuple,
+//  instance, enumerator, callable) which are not reachable from anywhere,
+//  and breaks them.
+//
+//  roots are found by trial deletion: if a tracked object has more references
+//  than the ones from other tracked objects, it is referenced by something else
+//  (evaluator frames, constant Value in AST, builtins, or C++ locals),
+//  so everything reachable from it is alive.
+//
+//  collection runs only at safepoint(), between statements.
+//
+//  objects are tracked by the thread which allocated them.
+//  to pass objects to other thread, detach() them from this thread
+//  and adopt() them in other thread. (see Evaluator::spawn)
+//
+
+struct Config {
+  bool enabled = true;
+  bool print_stats = false;
+
+  // tracked allocations before first collection.
+  // next collection runs after max(threshold, live objects) allocations.
+  size_t threshold = 10000;
+};
+
+// statistics of current thread
+struct Stats {
+  size_t collections = 0;
+
+  size_t allocated = 0; // total tracked objects
+  size_t traced = 0;    // total objects visited by collector
+  size_t freed = 0;     // total objects freed by collector
+
+  size_t live = 0;      // tracked objects after last collection
+  size_t max_live = 0;
+
+  double time_ms = 0;   // total time of collections
+};
+
+Config& get_config();
+Stats const& get_stats();
+
+void set_threshold(size_t threshold);
+
+void track(Object* obj);
+void untrack(Object* obj);
+
+// untrack obj and all tracked objects reachable from it.
+void detach(Object* obj);
+
+// track objects detached by detach().
+void adopt(Object* obj);
+
+// untrack all objects of this thread. (before exit of thread)
+void release_thread();
+
+//
+// objects shared by threads of parallel for
+//
+//  freeze() marks obj and everything reachable from it, so counts of them are
+//  changed atomically (see ObjRef), and an object of which count becomes zero
+//  is passed to defer_delete() instead of deleted by other thread.
+//
+//  after the loop, the thread which froze them calls unfreeze().
+//
+
+void freeze(Object* obj, vector<Object*>& frozen);
+
+// clear flags, and delete objects passed to defer_delete().
+void unfreeze(vector<Object*>& frozen, vector<Object*>& deferred);
+
+// objects passed to defer_delete() on this thread. (list is cleared)
+vector<Object*> take_deferred();
+
+// untrack all objects of this thread as detach(), to be adopted by other thread.
+vector<Object*> detach_thread();
+
+// return = count of freed objects
+size_t collect();
+
+void print_stats();
+
+extern thread_local size_t allocated_since_collect;
+extern thread_local size_t next_collect;
+
+inline void safepoint() {
+  if (allocated_since_collect >= next_collect)
+    collect();
+}
+
+} // namespace fire::gc
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "types.h"
+
+namespace fire {
+
+//
+// HashMap
+//
+//  Open-addressing hash table with SwissTable layout.
+//
+//  Every slot has one control byte:
+//    0b0xxxxxxx  = full (low 7 bits of hash, "h2")
+//    kEmpty      = never used
+//    kDeleted    = tombstone
+//
+//  Lookup loads a group of control bytes at once (16 with SSE2, 8 with
+//  plain 64-bit arithmetic) and only compares keys whose h2 matched.
+//
+namespace hashmap {
+
+using ctrl_t = i8;
+
+constexpr ctrl_t kEmpty = -128;  // 0b10000000
+constexpr ctrl_t kDeleted = -2;  // 0b11111110
+
+inline size_t mix(size_t hash) {
+  // 128-bit multiply folding; spreads identity hashes of small ints.
+  auto r = static_cast<unsigned __int128>(hash) * 0x9E3779B97F4A7C15ull;
+  return static_cast<size_t>(r) ^ static_cast<size_t>(r >> 64);
+}
+
+inline size_t h1(size_t hash) {
+  return hash >> 7;
+}
+
+inline ctrl_t h2(size_t hash) {
+  return static_cast<ctrl_t>(hash & 0x7F);
+}
+
+//
+// set of matched positions in a group
+//  shift = log2(bits per position)
+template <int Shift>
+struct BitMask {
+  u64 mask;
+
+  int lowest() const {
+    return std::countr_zero(this->mask) >> Shift;
+  }
+
+  explicit operator bool() const {
+    return this->mask != 0;
+  }
+
+  BitMask& operator++() {
+    this->mask &= this->mask - 1;
+    return *this;
+  }
+
+  int operator*() const {
+    return this->lowest();
+  }
+
+  BitMask begin() const {
+    return *this;
+  }
+
+  BitMask end() const {
+    return BitMask{0};
+  }
+
+  bool operator!=(BitMask const& other) const {
+    return this->mask != other.mask;
+  }
+};
+
+#if defined(__SSE2__)
+
+struct Group {
+  static constexpr size_t width = 16;
+
+  __m128i ctrl;
+
+  explicit Group(ctrl_t const* pos)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const*>(pos))) {
+  }
+
+  BitMask<0> match(ctrl_t h) const {
+    return {static_cast<u32>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), this->ctrl)))};
+  }
+
+  BitMask<0> match_empty() const {
+    return this->match(kEmpty);
+  }
+
+  // both of kEmpty and kDeleted have the sign bit.
+  BitMask<0> match_empty_or_deleted() const {
+    return {static_cast<u32>(_mm_movemask_epi8(this->ctrl))};
+  }
+};
+
+#else
+
+struct Group {
+  static constexpr size_t width = 8;
+
+  static constexpr u64 lsbs = 0x0101010101010101ull;
+  static constexpr u64 msbs = 0x8080808080808080ull;
+
+  u64 ctrl;
+
+  explicit Group(ctrl_t const* pos) {
+    std::memcpy(&this->ctrl, pos, sizeof(u64));
+  }
+
+  // may have false positives; callers compare the key anyway.
+  BitMask<3> match(ctrl_t h) const {
+    auto x = this->ctrl ^ (lsbs * static_cast<u8>(h));
+    return {(x - lsbs) & ~x & msbs};
+  }
+
+  BitMask<3> match_empty() const {
+    return {(this->ctrl & ~(this->ctrl << 6)) & msbs};
+  }
+
+  BitMask<3> match_empty_or_deleted() const {
+    return {this->ctrl & msbs};
+  }
+};
+
+#endif
+
+} // namespace hashmap
+
+inline size_t hash_combine(size_t seed, size_t value) {
+  return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+template <class K, class V, class Hash, class Eq>
+class HashMap {
+  using ctrl_t = hashmap::ctrl_t;
+  using Group = hashmap::Group;
+
+  static constexpr size_t npos = ~size_t(0);
+  static constexpr size_t min_capacity = 16;
+
+public:
+  using value_type = std::pair<K const, V>;
+
+  class iterator {
+    friend class HashMap;
+
+    HashMap const* map;
+    size_t index;
+
+    void skip() {
+      while (this->index < this->map->_capacity && this->map->_ctrl[this->index] < 0)
+        this->index++;
+    }
+
+    iterator(HashMap const* map, size_t index)
+        : map(map),
+          index(index) {
+      this->skip();
+    }
+
+  public:
+    value_type& operator*() const {
+      return this->map->_slots[this->index];
+    }
+
+    value_type* operator->() const {
+      return &this->map->_slots[this->index];
+    }
+
+    iterator& operator++() {
+      this->index++;
+      this->skip();
+      return *this;
+    }
+
+    bool operator==(iterator const& other) const {
+      return this->index == other.index;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return this->index != other.index;
+    }
+  };
+
+  HashMap() = default;
+
+  HashMap(HashMap const&) = delete;
+  HashMap& operator=(HashMap const&) = delete;
+
+  HashMap(HashMap&& other) noexcept {
+    this->swap(other);
+  }
+
+  HashMap& operator=(HashMap&& other) noexcept {
+    if (this != &other) {
+      this->destroy();
+      this->swap(other);
+    }
+
+    return *this;
+  }
+
+  ~HashMap() {
+    this->destroy();
+  }
+
+  size_t size() const {
+    return this->_size;
+  }
+
+  bool empty() const {
+    return this->_size == 0;
+  }
+
+  iterator begin() const {
+    return iterator(this, 0);
+  }
+
+  iterator end() const {
+    return iterator(this, this->_capacity);
+  }
+
+  V* find(K const& key) const {
+    if (size_t i = this->find_index(key, Hash{}(key)); i != npos)
+      return &this->_slots[i].second;
+
+    return nullptr;
+  }
+
+  bool contains(K const& key) const {
+    return this->find(key) != nullptr;
+  }
+
+  //
+  // return = (value, inserted)
+  //
+  std::pair<V*, bool> try_emplace(K const& key, V value = V()) {
+    size_t const hash = Hash{}(key);
+
+    if (size_t i = this->find_index(key, hash); i != npos)
+      return {&this->_slots[i].second, false};
+
+    size_t i = this->find_insert_index(hash);
+
+    if (this->_ctrl[i] == hashmap::kEmpty &&
+        this->_size + this->_deleted >= this->max_load()) {
+      this->rehash(this->next_capacity());
+      i = this->find_insert_index(hash);
+    }
+
+    if (this->_ctrl[i] == hashmap::kDeleted)
+      this->_deleted--;
+
+    new (&this->_slots[i]) value_type(key, std::move(value));
+
+    this->set_ctrl(i, hashmap::h2(hashmap::mix(hash)));
+    this->_size++;
+
+    return {&this->_slots[i].second, true};
+  }
+
+  V& operator[](K const& key) {
+    return *this->try_emplace(key).first;
+  }
+
+  bool erase(K const& key) {
+    size_t i = this->find_index(key, Hash{}(key));
+
+    if (i == npos)
+      return false;
+
+    this->_slots[i].~value_type();
+
+    this->set_ctrl(i, hashmap::kDeleted);
+    this->_size--;
+    this->_deleted++;
+
+    return true;
+  }
+
+  void reserve(size_t count) {
+    size_t cap = min_capacity;
+
+    while (cap * 7 / 8 < count)
+      cap *= 2;
+
+    if (cap > this->_capacity)
+      this->rehash(cap);
+  }
+
+  void clear() {
+    this->destroy();
+  }
+
+private:
+  size_t max_load() const {
+    return this->_capacity - this->_capacity / 8;
+  }
+
+  size_t next_capacity() const {
+    if (this->_capacity == 0)
+      return min_capacity;
+
+    // mostly tombstones: rehash in place
+    if (this->_size * 2 < this->max_load())
+      return this->_capacity;
+
+    return this->_capacity * 2;
+  }
+
+  void set_ctrl(size_t i, ctrl_t h) {
+    this->_ctrl[i] = h;
+
+    // mirror the head so that a group load never wraps around
+    if (i < Group::width)
+      this->_ctrl[this->_capacity + i] = h;
+  }
+
+  size_t find_index(K const& key, size_t hash) const {
+    if (this->_capacity == 0)
+      return npos;
+
+    size_t const mixed = hashmap::mix(hash);
+    size_t const mask = this->_capacity - 1;
+
+    size_t offset = hashmap::h1(mixed) & mask;
+
+    for (size_t step = Group::width;; step += Group::width) {
+      Group g{this->_ctrl + offset};
+
+      for (int i : g.match(hashmap::h2(mixed))) {
+        size_t index = (offset + i) & mask;
+
+        if (Eq{}(this->_slots[index].first, key))
+          return index;
+      }
+
+      if (g.match_empty())
+        return npos;
+
+      offset = (offset + step) & mask;
+    }
+  }
+
+  size_t find_insert_index(size_t hash) {
+    if (this->_capacity == 0)
+      this->rehash(min_capacity);
+
+    size_t const mask = this->_capacity - 1;
+
+    size_t offset = hashmap::h1(hashmap::mix(hash)) & mask;
+
+    for (size_t step = Group::width;; step += Group::width) {
+      if (auto m = Group{this->_ctrl + offset}.match_empty_or_deleted(); m)
+        return (offset + m.lowest()) & mask;
+
+      offset = (offset + step) & mask;
+    }
+  }
+
+  void rehash(size_t new_capacity) {
+    auto old_ctrl = this->_ctrl;
+    auto old_slots = this->_slots;
+    auto old_capacity = this->_capacity;
+
+    this->_capacity = new_capacity;
+    this->_ctrl = new ctrl_t[new_capacity + Group::width];
+    this->_slots = static_cast<value_type*>(
+        ::operator new(sizeof(value_type) * new_capacity));
+
+    std::memset(this->_ctrl, hashmap::kEmpty, new_capacity + Group::width);
+
+    this->_deleted = 0;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (old_ctrl[i] < 0)
+        continue;
+
+      auto& slot = old_slots[i];
+      size_t hash = Hash{}(slot.first);
+      size_t index = this->find_insert_index(hash);
+
+      new (&this->_slots[index]) value_type(std::move(slot));
+      this->set_ctrl(index, hashmap::h2(hashmap::mix(hash)));
+
+      slot.~value_type();
+    }
+
+    delete[] old_ctrl;
+    ::operator delete(old_slots);
+  }
+
+  void destroy() {
+    for (size_t i = 0; i < this->_capacity; i++)
+      if (this->_ctrl[i] >= 0)
+        this->_slots[i].~value_type();
+
+    delete[] this->_ctrl;
+    ::operator delete(this->_slots);
+
+    this->_ctrl = nullptr;
+    this->_slots = nullptr;
+    this->_capacity = this->_size = this->_deleted = 0;
+  }
+
+  void swap(HashMap& other) {
+    std::swap(this->_ctrl, other._ctrl);
+    std::swap(this->_slots, other._slots);
+    std::swap(this->_capacity, other._capacity);
+    std::swap(this->_size, other._size);
+    std::swap(this->_deleted, other._deleted);
+  }
+
+  ctrl_t* _ctrl = nullptr;
+  value_type* _slots = nullptr;
+
+  size_t _capacity = 0;
+  size_t _size = 0;
+  size_t _deleted = 0;
+};
+
+} // namespace fire
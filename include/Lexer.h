@@ -15,7 +15,6 @@ private:
   bool check() const;
   char peek();
   void pass_space();
-  bool match(std::string_view);
 
   bool eat(char c) {
     if (this->peek() == c) {
@@ -26,17 +25,8 @@ private:
     return false;
   }
 
-  bool eat(std::string_view s) {
-    if (this->match(s)) {
-      this->position += s.length();
-      return true;
-    }
-
-    return false;
-  }
-
-  std::string_view trim(i64 len) {
-    return std::string_view(this->source.data.data() + this->position, len);
+  std::string_view trim(i64 pos, i64 len) {
+    return this->src_view.substr(pos, len);
   }
 
   SourceStorage& source;
@@ -4,6 +4,8 @@
 #include <string>
 #include <map>
 #include "TypeInfo.h"
+#include "HashMap.h"
+#include "Allocator.h"
 
 namespace fire {
 
@@ -12,10 +14,26 @@ struct Function;
 }
 
 struct Object {
-  TypeInfo type;
-  // i64 ref_count;
+  TypeId type;
+
+  // count of ObjRef pointing to this. (see types.h)
+  i64 ref_count = 0;
+
+  // shared by threads of parallel for. count is changed atomically,
+  // and the object is not deleted until the loop ends. (see gc::freeze)
+  bool is_frozen = false;
+
   bool is_marked;
 
+  // for gc::collect()
+  bool is_tracked = false;
+  bool is_detached = false;
+  i64 gc_refs = 0;
+  size_t gc_index = 0;
+
+  // objects of this type can make cycle, created by ObjNew are tracked by gc.
+  static constexpr bool is_traced = false;
+
   bool is_callable() const {
     return this->type.kind == TypeKind::Function;
   }
@@ -56,16 +74,29 @@ struct Object {
     return this->type.kind == TypeKind::Vector;
   }
 
+  bool is_dict() const {
+    return this->type.kind == TypeKind::Dict;
+  }
+
+  bool is_tuple() const {
+    return this->type.kind == TypeKind::Tuple;
+  }
+
   i64 get_vi() const;
   double get_vf() const;
   char16_t get_vc() const;
   bool get_vb() const;
 
-  virtual bool Equals(ObjPointer obj) const {
+  virtual bool Equals(ObjPointer const& obj) const {
     (void)obj;
     return false;
   }
 
+  // only for hashable types. (see TypeInfo::is_hashable)
+  virtual size_t Hash() const {
+    return reinterpret_cast<size_t>(this);
+  }
+
   template <typename T>
   T* As() {
     return static_cast<T*>(this);
@@ -84,11 +115,34 @@ struct Object {
     return this->As<ObjPrimitive>();
   }
 
-  virtual ~Object() = default;
+  // objects are allocated from pool. (see Allocator.h)
+  static void* operator new(size_t size) {
+    return alloc::allocate(size);
+  }
+
+  static void operator delete(void* p, size_t size) {
+    alloc::deallocate(p, size);
+  }
+
+  virtual ~Object() {
+#if !_DBG_DONT_USE_SMART_PTR_
+    if (this->is_tracked)
+      gc::untrack(this);
+#endif
+  }
 
   virtual ObjPointer Clone() const = 0;
   virtual std::string ToString() const = 0;
 
+  // append objects referenced by this. (for gc)
+  virtual void Trace(vector<Object*>& out) const {
+    (void)out;
+  }
+
+  // drop all references to break cycle. (for gc)
+  virtual void ClearRefs() {
+  }
+
   std::string ToStringAsMember() const {
     auto s = this->ToString();
 
@@ -101,7 +155,31 @@ struct Object {
   }
 
 protected:
-  Object(TypeInfo type);
+  Object(TypeId type);
+
+  // copy is a new object: not counted and not tracked yet.
+  Object(Object const& other)
+      : type(other.type) {
+  }
+
+  Object& operator=(Object const&) = delete;
+};
+
+//
+// CloneMemo
+//
+//  while alive, Clone() of containers copies each object only once,
+//  so shared and cyclic references are kept in the copy.
+//  (used to pass objects to other thread, see Evaluator::spawn)
+//
+struct CloneMemo {
+  CloneMemo();
+  ~CloneMemo();
+
+  // copy of obj if already cloned in this memo
+  static ObjPointer Find(Object const* obj);
+
+  static void Add(Object const* obj, ObjPointer const& copy);
 };
 
 struct ObjNone : Object {
@@ -113,7 +191,7 @@ struct ObjNone : Object {
     return "none";
   }
 
-  bool Equals(ObjPointer) const override {
+  bool Equals(ObjPointer const&) const override {
     return true;
   }
 
@@ -134,10 +212,23 @@ struct ObjPrimitive : Object {
 
   ObjPrimitive* to_float();
 
+  // value of int, char or bool as integer
+  i64 as_integer() const {
+    switch (this->type.kind) {
+    case TypeKind::Char:
+      return this->vc;
+
+    case TypeKind::Bool:
+      return this->vb;
+    }
+
+    return this->vi;
+  }
+
   ObjPointer Clone() const override;
   std::string ToString() const override;
 
-  bool Equals(ObjPointer obj) const override {
+  bool Equals(ObjPointer const& obj) const override {
     if (!this->type.equals(obj->type))
       return false;
 
@@ -155,6 +246,8 @@ struct ObjPrimitive : Object {
     return this->vi == obj->get_vi();
   }
 
+  size_t Hash() const override;
+
   ObjPrimitive(i64 vi = 0)
       : Object(TypeKind::Int),
         vi(vi) {};
@@ -172,45 +265,117 @@ struct ObjPrimitive : Object {
         vc(vc) {};
 };
 
+//
+// Columns
+//
+//  columnar storage of vector of class instances.
+//  each member variable has one contiguous column;
+//  raw value fields (see AST::Class::layout) are in `raw`, others in `boxed`.
+//
+struct Columns {
+  struct Column {
+    vector<u64> raw;
+    ObjVector boxed;
+  };
+
+  ASTPtr<AST::Class> ast;
+  vector<Column> columns;
+
+  size_t count = 0;
+
+  ObjPointer Get(size_t row, size_t index) const;
+  void Set(size_t row, size_t index, ObjPointer obj);
+
+  void Append(ObjPtr<ObjInstance> inst);
+  void SetRow(size_t row, ObjPtr<ObjInstance> inst);
+
+  // new instance with fields of the row
+  ObjPtr<ObjInstance> GetRow(size_t row) const;
+
+  std::shared_ptr<Columns> Clone() const;
+
+  Columns(ASTPtr<AST::Class> ast);
+};
+
 struct ObjIterable : Object {
   ObjVector list;
 
+  // elements are stored here instead of list when not null.
+  //  (see vector.to_columns())
+  std::shared_ptr<Columns> columns;
+
   ObjPointer& Append(ObjPointer obj) {
     return this->list.emplace_back(obj);
   }
 
-  void AppendList(ObjPtr<ObjIterable> obj) {
-    for (auto&& e : obj->list)
-      this->Append(e->Clone());
-  }
+  void AppendList(ObjPtr<ObjIterable> obj);
 
   size_t Count() const {
-    return this->list.size();
+    return this->columns ? this->columns->count : this->list.size();
+  }
+
+  // element at index; reference to the row if columnar. (new ObjRowRef
+  // for each call, so member access of v[i] reads columns directly)
+  ObjPointer At(size_t index) const;
+
+  bool is_columnar() const {
+    return this->columns != nullptr;
+  }
+
+  // return false if element type is not a class.
+  bool ToColumns();
+  void ToRows();
+
+  static constexpr bool is_traced = true;
+
+  // Columns is not traced; referenced objects from it are always alive.
+  void Trace(vector<Object*>& out) const override {
+    for (auto&& e : this->list)
+      out.emplace_back(e.get());
+  }
+
+  void ClearRefs() override {
+    this->list.clear();
+    this->columns = nullptr;
   }
 
   ObjPointer Clone() const override;
   std::string ToString() const override;
 
-  bool Equals(ObjPointer obj) const override {
-    if (!obj->type.is_iterable())
+  bool Equals(ObjPointer const& obj) const override {
+    if (!obj->is_iterable())
       return false;
 
-    if (this->list.size() != obj->As<ObjIterable>()->list.size())
+    auto other = obj->As<ObjIterable>();
+
+    if (this->Count() != other->Count())
       return false;
 
-    for (auto it = this->list.begin(); auto&& e : obj->As<ObjIterable>()->list)
-      if (!(*it++)->Equals(e))
+    if (this->is_columnar() || other->is_columnar()) {
+      for (size_t i = 0; i < this->Count(); i++)
+        if (!this->At(i)->Equals(other->At(i)))
+          return false;
+
+      return true;
+    }
+
+    // no copy of elements: constants in AST (keys of match) are compared
+    // on threads of spawn() at same time, and their counts are not atomic.
+    for (size_t i = 0; i < this->list.size(); i++)
+      if (!this->list[i]->Equals(other->list[i]))
         return false;
 
     return true;
   }
 
-  ObjIterable(TypeInfo type)
+  ObjIterable(TypeId type)
       : Object(type) {
   }
 };
 
 struct ObjString : ObjIterable {
+  static constexpr bool is_traced = false;
+
   ObjPointer SubString(size_t pos, size_t length = 0);
 
   size_t Length() const {
@@ -221,6 +386,8 @@ struct ObjString : ObjIterable {
 
   ObjPointer Clone() const override;
 
+  size_t Hash() const override;
+
   ObjString(std::u16string const& str = u"");
   ObjString(std::string const& str);
 };
@@ -235,8 +402,13 @@ struct ObjEnumerator : Object {
   ObjPointer data = nullptr;
 
   ObjPointer Clone() const override {
+    if (auto p = CloneMemo::Find(this); p)
+      return p;
+
     auto x = ObjNew<ObjEnumerator>(this->ast, this->index);
 
+    CloneMemo::Add(this, x);
+
     if (this->data)
       x->data = this->data->Clone();
 
@@ -245,7 +417,7 @@ struct ObjEnumerator : Object {
 
   std::string ToString() const override;
 
-  bool Equals(ObjPointer obj) const override {
+  bool Equals(ObjPointer const& obj) const override {
     if (obj->type.kind != TypeKind::Enumerator)
       return false;
 
@@ -263,23 +435,170 @@ struct ObjEnumerator : Object {
     return true;
   }
 
+  size_t Hash() const override;
+
+  static constexpr bool is_traced = true;
+
+  void Trace(vector<Object*>& out) const override {
+    if (this->data)
+      out.emplace_back(this->data.get());
+  }
+
+  void ClearRefs() override {
+    this->data = nullptr;
+  }
+
   ObjEnumerator(ASTPtr<AST::Enum> ast, int index);
 };
 
+//
+// TypeKind::Tuple
+//
+//  type.params = types of elements
+//
+//  up to 4 elements are stored in the object itself,
+//  so a small tuple is one allocation.
+//
+struct ObjTuple : Object {
+  static constexpr size_t inline_count = 4;
+
+  size_t count;
+
+  ObjPointer elements[inline_count];
+  ObjVector extra; // elements after inline_count
+
+  ObjPointer& Get(size_t index) {
+    return index < inline_count ? this->elements[index]
+                                : this->extra[index - inline_count];
+  }
+
+  ObjPointer const& Get(size_t index) const {
+    return index < inline_count ? this->elements[index]
+                                : this->extra[index - inline_count];
+  }
+
+  size_t Count() const {
+    return this->count;
+  }
+
+  ObjPointer Clone() const override;
+  std::string ToString() const override;
+
+  bool Equals(ObjPointer const& obj) const override;
+  size_t Hash() const override;
+
+  static constexpr bool is_traced = true;
+
+  void Trace(vector<Object*>& out) const override {
+    for (size_t i = 0; i < this->count; i++)
+      if (this->Get(i))
+        out.emplace_back(this->Get(i).get());
+  }
+
+  void ClearRefs() override {
+    for (auto&& e : this->elements)
+      e = nullptr;
+
+    this->extra.clear();
+    this->count = 0;
+  }
+
+  ObjTuple(TypeId type, size_t count)
+      : Object(std::move(type)),
+        count(count) {
+    if (count > inline_count)
+      this->extra.resize(count - inline_count);
+  }
+};
+
+//
+// TypeKind::Dict
+//
+//  type.params[0] = key
+//  type.params[1] = value
+//
+struct ObjDict : Object {
+  struct KeyHash {
+    size_t operator()(ObjPointer const& key) const {
+      return key->Hash();
+    }
+  };
+
+  struct KeyEqual {
+    bool operator()(ObjPointer const& a, ObjPointer const& b) const {
+      return a->Equals(b);
+    }
+  };
+
+  using Table = HashMap<ObjPointer, ObjPointer, KeyHash, KeyEqual>;
+
+  Table table;
+
+  size_t Count() const {
+    return this->table.size();
+  }
+
+  ObjPointer* Find(ObjPointer const& key) const {
+    return this->table.find(key);
+  }
+
+  // insert if not found
+  ObjPointer& Get(ObjPointer const& key) {
+    return this->table[key];
+  }
+
+  void Insert(ObjPointer const& key, ObjPointer value) {
+    *this->table.try_emplace(key).first = std::move(value);
+  }
+
+  bool Remove(ObjPointer const& key) {
+    return this->table.erase(key);
+  }
+
+  ObjVector Keys() const;
+
+  ObjPointer Clone() const override;
+  std::string ToString() const override;
+
+  bool Equals(ObjPointer const& obj) const override;
+
+  static constexpr bool is_traced = true;
+
+  void Trace(vector<Object*>& out) const override {
+    for (auto&& [k, v] : this->table) {
+      out.emplace_back(k.get());
+
+      if (v)
+        out.emplace_back(v.get());
+    }
+  }
+
+  void ClearRefs() override {
+    this->table.clear();
+  }
+
+  ObjDict(TypeId type)
+      : Object(std::move(type)) {
+  }
+};
+
 //
 // instance of class
+//
+// ObjInstance
+//
+//  member variables are stored in same memory block with this object.
+//  (created by ObjInstance::New, see AST::Class::layout)
+//
 struct ObjInstance : Object {
   ASTPtr<AST::Class> ast;
 
-  ObjVector member_variables;
+  u8* fields = nullptr;
 
-  ObjPointer& add_member_var(ObjPointer obj) {
-    return this->member_variables.emplace_back(obj);
-  }
+  ObjPointer get_mvar(i64 index) const;
+  void set_mvar(i64 index, ObjPointer obj);
 
-  ObjPointer& get_mvar(i64 index) {
-    return this->member_variables[index];
-  }
+  static ObjPtr<ObjInstance> New(ASTPtr<AST::Class> ast);
 
   bool have_constructor() const;
   ASTPtr<AST::Function> get_constructor() const;
@@ -287,11 +606,58 @@ struct ObjInstance : Object {
   ObjPointer Clone() const override;
   std::string ToString() const override;
 
-  bool Equals(ObjPointer obj) const override {
+  bool Equals(ObjPointer const& obj) const override {
     return this->ast == obj->As<ObjInstance>()->ast;
   }
 
+  static constexpr bool is_traced = true;
+
+  void Trace(vector<Object*>& out) const override;
+  void ClearRefs() override;
+
   ObjInstance(ASTPtr<AST::Class> ast);
+  ~ObjInstance();
+
+  // block size is not sizeof(ObjInstance), but known only before destruction.
+  // (see New)
+  static void operator delete(ObjInstance* p, std::destroying_delete_t);
+};
+
+//
+// ObjRowRef
+//
+//  element of columnar vector, refers to one row of the vector.
+//  (fields is null)
+//
+//  it refers to the index, not to the instance stored there:
+//  after sort_by() it sees the instance moved into the row, and after
+//  to_rows() it reads and writes the instance at the index.
+//  assigning to the row (v[i] = x) copies fields of x into the row.
+//
+struct ObjRowRef : ObjInstance {
+  ObjPtr<ObjIterable> vec;
+  size_t row;
+
+  static constexpr bool is_traced = true;
+
+  void Trace(vector<Object*>& out) const override {
+    out.emplace_back(this->vec.get());
+  }
+
+  void ClearRefs() override {
+    this->vec = nullptr;
+  }
+
+  ObjRowRef(ObjPtr<ObjIterable> vec, size_t row)
+      : ObjInstance(vec->columns->ast),
+        vec(std::move(vec)),
+        row(row) {
+  }
+
+  // allocated by ObjNew, not by ObjInstance::New.
+  static void operator delete(void* p, size_t size) {
+    alloc::deallocate(p, size);
+  }
 };
 
 //
@@ -314,17 +680,139 @@ struct ObjCallable : Object {
   ObjPointer Clone() const override;
   std::string ToString() const override;
 
-  bool Equals(ObjPointer obj) const override {
+  bool Equals(ObjPointer const& obj) const override {
     auto x = obj->As<ObjCallable>();
 
     return this->func == x->func && this->builtin == x->builtin &&
            this->is_named == x->is_named;
   }
 
+  static constexpr bool is_traced = true;
+
+  void Trace(vector<Object*>& out) const override {
+    if (this->selfobj)
+      out.emplace_back(this->selfobj.get());
+  }
+
+  void ClearRefs() override {
+    this->selfobj = nullptr;
+  }
+
   ObjCallable(ASTPtr<AST::Function> fp);
   ObjCallable(builtins::Function const* fp);
 };
 
+//
+// ObjThread
+//
+//  handle of thread created by spawn(). (see Evaluator::spawn)
+//  clone of handle refers to same thread.
+//
+struct ThreadState;
+
+struct ObjThread : Object {
+  std::shared_ptr<ThreadState> state;
+
+  // wait for the thread, and return result of callable.
+  // exception thrown in the thread is thrown again here.
+  ObjPointer Join(ASTPointer loc);
+
+  ObjPointer Clone() const override {
+    return ObjNew<ObjThread>(*this);
+  }
+
+  std::string ToString() const override;
+
+  ObjThread(TypeId type, std::shared_ptr<ThreadState> state)
+      : Object(type),
+        state(std::move(state)) {
+  }
+};
+
+//
+// ObjChannel
+//
+//  handle of channel<T>. (see Channel.h)
+//  clone of handle refers to same channel.
+//
+class Channel;
+
+struct ObjChannel : Object {
+  std::shared_ptr<Channel> channel;
+
+  // obj is moved to channel if not referenced from others, or copied.
+  void Send(ObjPointer obj, ASTPointer loc);
+
+  // wait for object. return = null if channel is closed and empty.
+  ObjPointer Recv();
+
+  ObjPointer Clone() const override {
+    return ObjNew<ObjChannel>(*this);
+  }
+
+  std::string ToString() const override;
+
+  ObjChannel(TypeId type, std::shared_ptr<Channel> channel)
+      : Object(type),
+        channel(std::move(channel)) {
+  }
+};
+
+//
+// ObjFuture
+//
+//  result of async function or async I/O, taken by await.
+//  clone of handle refers to same result.
+//
+namespace io {
+struct FutureState;
+}
+
+struct ObjFuture : Object {
+  std::shared_ptr<io::FutureState> state;
+
+  ObjPointer Clone() const override {
+    return ObjNew<ObjFuture>(*this);
+  }
+
+  std::string ToString() const override {
+    return "<future>";
+  }
+
+  ObjFuture(TypeId type, std::shared_ptr<io::FutureState> state)
+      : Object(type),
+        state(std::move(state)) {
+  }
+};
+
+//
+// ObjGenerator
+//
+//  result of generator function, iterated by for-in.
+//  (see Evaluator::make_generator)
+//  clone of handle refers to same generator.
+//
+namespace eval {
+struct GeneratorState;
+}
+
+struct ObjGenerator : Object {
+  std::shared_ptr<eval::GeneratorState> state;
+
+  ObjPointer Clone() const override {
+    return ObjNew<ObjGenerator>(*this);
+  }
+
+  std::string ToString() const override {
+    return "<generator>";
+  }
+
+  ObjGenerator(TypeId type, std::shared_ptr<eval::GeneratorState> state)
+      : Object(type),
+        state(std::move(state)) {
+  }
+};
+
 //
 // TypeKind::Module
 //
@@ -368,7 +856,7 @@ struct ObjType : Object {
 
   std::string ToString() const override;
 
-  bool Equals(ObjPointer obj) const override {
+  bool Equals(ObjPointer const& obj) const override {
     auto x = obj->As<ObjType>();
 
     return this->typeinfo.equals(x->typeinfo) || this->ast_enum == x->ast_enum ||
@@ -19,13 +19,7 @@ public:
   ASTPointer IndexRef();
   ASTPointer Unary();
 
-  ASTPointer Mul();
-  ASTPointer Add();
-  ASTPointer Shift();
-  ASTPointer Compare();
-  ASTPointer BitCalc();
-  ASTPointer LogAndOr();
-  ASTPointer Assign();
+  ASTPointer Binary(int min_prec);
 
   ASTPointer Expr();
   ASTPointer Stmt();
@@ -38,6 +32,7 @@ private:
   bool check() const;
 
   bool eat(std::string_view str);
+  bool eat(Keyword kw);
   void expect(std::string_view str, bool keep_token = false);
 
   bool eat_typeparam_bracket_open();
@@ -54,6 +49,10 @@ private:
     return this->cur->kind == kind;
   }
 
+  bool match(Keyword kw) {
+    return this->cur->keyword == kw;
+  }
+
   bool match(std::pair<TokenKind, std::string_view> pair) {
     return this->match(pair.first) && this->match(pair.second);
   }
@@ -73,13 +72,6 @@ private:
     return ret;
   }
 
-  TokenIterator insert_token(Token tok) {
-    this->cur = this->tokens.insert(this->cur, tok);
-    this->end = this->tokens.end();
-
-    return this->cur;
-  }
-
   TokenIterator expectIdentifier();
 
   ASTPtr<AST::TypeName> expectTypeName();
@@ -5,6 +5,7 @@
 #include <tuple>
 
 #include "AST.h"
+#include "HashMap.h"
 
 namespace fire::semantics_checker {
 
@@ -30,7 +31,7 @@ struct ScopeContext {
   struct LocalVar {
     string_view name;
 
-    TypeInfo deducted_type;
+    TypeId deducted_type;
     bool is_type_deducted = false;
 
     bool is_argument = false;
@@ -93,6 +94,19 @@ protected:
 //  BlockScope
 
 struct BlockScope : ScopeContext {
+  //
+  // declarations of a name in this block.
+  //
+  struct Symbol {
+    int var = -1; // index in variables
+
+    ASTVec<AST::Function> functions;
+
+    ASTPtr<AST::Enum> ast_enum = nullptr;
+    ASTPtr<AST::Class> ast_class = nullptr;
+    ASTPtr<AST::Block> ast_namespace = nullptr;
+  };
+
   ASTPtr<AST::Block> ast;
 
   vector<LocalVar> variables;
@@ -109,6 +123,13 @@ struct BlockScope : ScopeContext {
 
   LocalVar* find_var(string_view const& name) override;
 
+  // null if name is not declared in this block.
+  Symbol const* get_symbol(string_view name);
+
+  // makes table of get_symbol() if not made yet.
+  // (called before scope is shared by threads, see Sema::check_functions_parallel)
+  void make_symbols();
+
   ScopeContext* find_child_scope(ASTPointer ast) override;
   ScopeContext* find_child_scope(ScopeContext* ctx) override;
 
@@ -126,6 +147,18 @@ struct BlockScope : ScopeContext {
 
   BlockScope(int depth, ASTPtr<AST::Block> ast, int index_add = 0);
   ~BlockScope();
+
+private:
+  //
+  // name => declarations  (made at first lookup, see get_symbol)
+  //
+  //  variables of this scope and statements of the block are not changed
+  //  after all scopes are made in Sema::Sema, so the table is made once.
+  //
+  HashMap<string_view, Symbol, std::hash<string_view>, std::equal_to<string_view>>
+      symbols;
+
+  bool has_symbols = false;
 };
 
 // ------------------------------------
@@ -140,6 +173,9 @@ struct FunctionScope : ScopeContext {
 
   TypeInfo result_type;
 
+  // T of generator<T> if function has yield
+  TypeInfo yield_type;
+
   ASTVec<AST::Statement> return_stmt_list;
 
   bool is_templated() const {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <exception>
 #include <optional>
 #include <tuple>
 #include <list>
@@ -110,12 +111,6 @@ class Sema {
                                                      bool ignore_mismatch);
 
   ScopeContext::LocalVar* _find_variable(string_view const& name);
-  ASTVec<Function> _find_func(string_view const& name);
-  ASTPtr<Enum> _find_enum(string_view const& name);
-  ASTPtr<Class> _find_class(string_view const& name);
-  ASTPtr<Block> _find_namespace(string_view const& name);
-
-  ASTPointer context_reverse_search(std::function<bool(ASTPointer)> func);
 
   NameFindResult find_name(string_view const& name, bool const only_cur_scope = false);
 
@@ -135,15 +130,22 @@ public:
   Sema(ASTPtr<AST::Block> prg);
   ~Sema();
 
-  void check_full();
+  //
+  // jobs = count of threads to check functions. (see check_functions_parallel)
+  //
+  void check_full(size_t jobs = 1);
 
   void check(ASTPointer ast);
 
-  TypeInfo eval_type(ASTPointer ast);
+  //
+  // result is interned. (types of variables and values are returned
+  // without copy, and compared by index)
+  //
+  TypeId eval_type(ASTPointer ast);
 
   TypeInfo eval_type_name(ASTPtr<AST::TypeName> ast);
 
-  TypeInfo EvalExpr(ASTPtr<AST::Expr> ast);
+  TypeId EvalExpr(ASTPtr<AST::Expr> ast);
 
   bool IsWritable(ASTPointer ast);
 
@@ -193,6 +195,9 @@ private:
     // index of error item
     size_t index = 0;
 
+    // instance in _applied_templates (set by try_apply_template_function)
+    i64 instance = -1;
+
     Parameter& add_parameter(string_view name, TypeInfo type);
     Parameter* find_parameter(string_view name);
 
@@ -208,7 +213,58 @@ private:
 
   friend struct TemplateTypeApplier;
 
-  std::vector<TemplateTypeApplier> _applied_templates;
+  //
+  // checked instance of template function
+  //
+  //  signature is evaluated once with the parameters, and used by all
+  //  call sites of same instance.
+  //
+  struct TemplateInstance {
+    TemplateTypeApplier applied;
+
+    // false while checking body (recursive call)
+    bool checked = false;
+
+    TypeInfo result_type;
+    TypeVec arg_types;
+  };
+
+  //
+  // template and types of parameters (in order of parameter_list)
+  //
+  struct InstanceKey {
+    ASTPtr<AST::Templatable> ast;
+    vector<TypeId> types;
+
+    bool operator==(InstanceKey const& k) const {
+      return this->ast == k.ast && this->types == k.types;
+    }
+  };
+
+  struct InstanceKeyHash {
+    size_t operator()(InstanceKey const& k) const {
+      size_t h = std::hash<ASTPtr<AST::Templatable>>()(k.ast);
+
+      for (auto&& t : k.types)
+        h = hash_combine(h, t.index);
+
+      return h;
+    }
+  };
+
+  std::vector<TemplateInstance> _applied_templates;
+
+  // key => index in _applied_templates
+  HashMap<InstanceKey, i64, InstanceKeyHash, std::equal_to<InstanceKey>>
+      _applied_map;
+
+  //
+  // instances which have Unknown type in parameters.
+  // (Unknown matches any type, so they are found by scan)
+  //
+  HashMap<ASTPtr<AST::Templatable>, vector<i64>, std::hash<ASTPtr<AST::Templatable>>,
+          std::equal_to<ASTPtr<AST::Templatable>>>
+      _applied_unknown;
 
   std::list<TemplateTypeApplier*> _applied_ptr_stack;
 
@@ -223,7 +279,16 @@ private:
   bool try_apply_template_function(TemplateTypeApplier& out, ASTPtr<AST::Function> ast,
                                    TypeVec const& args, TypeVec const& func_args);
 
-  TemplateTypeApplier* _find_applied(TemplateTypeApplier const& t);
+  // index in _applied_templates, or -1
+  i64 _find_applied(TemplateTypeApplier const& t);
+
+  // null if not applied, or signature is not evaluated yet
+  TemplateInstance const* get_checked_instance(TemplateTypeApplier const& t) {
+    if (t.instance == -1 || !this->_applied_templates[t.instance].checked)
+      return nullptr;
+
+    return &this->_applied_templates[t.instance];
+  }
 
   ASTPtr<Block> root;
 
@@ -250,6 +315,8 @@ private:
     this->GetHistory().clear();
   }
 
+  vector<std::list<ScopeContext*>> _bak_list;
+
   void SaveScopeLocation();
   void RestoreScopeLocation();
 
@@ -258,6 +325,36 @@ private:
 
   int GetScopesOfDepth(vector<ScopeContext*>& out, ScopeContext* scope, int depth);
 
+  // parallel for statements, checked after all functions. (see check_parallel_for)
+  ASTVec<AST::Statement> parallel_for_list;
+
+  void check_parallel_for(ASTPtr<AST::Statement> ast);
+
+  //
+  // result of function checked on other thread.
+  // (used when check() reaches the function, see check_functions_parallel)
+  //
+  struct CheckedFunction {
+    std::exception_ptr error = nullptr;
+
+    ASTVec<AST::Statement> parallel_for_list;
+  };
+
+  HashMap<ASTPtr<AST::Function>, CheckedFunction, std::hash<ASTPtr<AST::Function>>,
+          std::equal_to<ASTPtr<AST::Function>>>
+      checked_functions;
+
+  // this is worker of other Sema, if not null. (scopes are owned by parent)
+  Sema* parent = nullptr;
+
+  explicit Sema(Sema* parent);
+
+  void check_functions_parallel(size_t jobs);
+
+  FunctionScope* get_function_scope(ASTPtr<AST::Function> ast) {
+    return *(this->parent ? this->parent : this)->function_scope_map.find(ast);
+  }
+
   TypeInfo ExpectType(TypeInfo const& type, ASTPointer ast);
   TypeInfo* GetExpectedType();
 
@@ -265,7 +362,9 @@ private:
 
   vector<TypeInfo> _expected;
 
-  vector<std::pair<ASTPtr<AST::Function>, FunctionScope*>> function_scope_map;
+  HashMap<ASTPtr<AST::Function>, FunctionScope*, std::hash<ASTPtr<AST::Function>>,
+          std::equal_to<ASTPtr<AST::Function>>>
+      function_scope_map;
 
   ASTVec<Enum> enums;
   ASTVec<Class> classes;
@@ -292,20 +391,41 @@ private:
   TypeInfo make_functor_type(ASTPtr<AST::Function> ast);
   TypeInfo make_functor_type(builtins::Function const* builtin);
 
-  std::vector<IdentifierInfo> _identifier_info_keep;
+  //
+  // TypeInfo::is_hashable(), and arguments of enumerators are hashable.
+  // (hash of enumerator is made from its argument)
+  //
+  bool is_hashable(TypeInfo const& type);
+
+  // enums in is_hashable() (recursive types)
+  ASTVector _hashable_checking;
+
+  //
+  // objects passed to other thread by spawn() or channel<T>.
+  // generator and future are bound to evaluator and event loop of the
+  // thread which made them, so they (and containers of them) can't be sent.
+  //
+  bool is_sendable(TypeInfo const& type);
+
+  void check_sendable(ASTPointer ast, TypeInfo const& type);
+
+  // classes and enums in is_sendable() (recursive types)
+  ASTVector _sendable_checking;
+
+  HashMap<ASTPtr<AST::Identifier>, IdentifierInfo, std::hash<ASTPtr<AST::Identifier>>,
+          std::equal_to<ASTPtr<AST::Identifier>>>
+      _identifier_info_keep;
 
   // std::vector<std::pair<ASTPtr<AST::Identifier>, TypeInfo>> id_result_keep;
 
   IdentifierInfo* get_keeped_id_info(ASTPtr<AST::Identifier> id) {
-    for (auto&& info : _identifier_info_keep)
-      if (info.ast == id)
-        return &info;
-
-    return nullptr;
+    return _identifier_info_keep.find(id);
   }
 
   IdentifierInfo& keep_id(IdentifierInfo info) {
-    return _identifier_info_keep.emplace_back(std::move(info));
+    auto id = info.ast;
+
+    return *_identifier_info_keep.try_emplace(id, std::move(info)).first;
   }
 };
 
@@ -0,0 +1,423 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace fire::sort {
+
+//
+// pdqsort  (pattern-defeating quicksort)
+//
+//  introsort with median-of-3 / ninther pivot, partial insertion sort on
+//  already partitioned ranges, and a fallback to heapsort when too many
+//  unbalanced partitions have been seen.
+//
+//  comp must be a strict weak ordering.
+//
+namespace detail {
+
+constexpr ptrdiff_t insertion_sort_threshold = 24;
+constexpr ptrdiff_t ninther_threshold = 128;
+constexpr ptrdiff_t partial_insertion_sort_limit = 8;
+
+// element count per thread for parallel sort
+constexpr size_t parallel_threshold = 1 << 15;
+
+template <class Iter, class Comp>
+void insertion_sort(Iter begin, Iter end, Comp& comp) {
+  if (begin == end)
+    return;
+
+  for (Iter cur = begin + 1; cur != end; ++cur) {
+    if (!comp(*cur, *(cur - 1)))
+      continue;
+
+    auto tmp = std::move(*cur);
+    Iter sift = cur;
+
+    do {
+      *sift = std::move(*(sift - 1));
+      --sift;
+    } while (sift != begin && comp(tmp, *(sift - 1)));
+
+    *sift = std::move(tmp);
+  }
+}
+
+// *(begin - 1) must not be greater than any element in range.
+template <class Iter, class Comp>
+void unguarded_insertion_sort(Iter begin, Iter end, Comp& comp) {
+  if (begin == end)
+    return;
+
+  for (Iter cur = begin + 1; cur != end; ++cur) {
+    if (!comp(*cur, *(cur - 1)))
+      continue;
+
+    auto tmp = std::move(*cur);
+    Iter sift = cur;
+
+    do {
+      *sift = std::move(*(sift - 1));
+      --sift;
+    } while (comp(tmp, *(sift - 1)));
+
+    *sift = std::move(tmp);
+  }
+}
+
+// give up (return false) when too many elements have been moved.
+template <class Iter, class Comp>
+bool partial_insertion_sort(Iter begin, Iter end, Comp& comp) {
+  if (begin == end)
+    return true;
+
+  ptrdiff_t moved = 0;
+
+  for (Iter cur = begin + 1; cur != end; ++cur) {
+    if (!comp(*cur, *(cur - 1)))
+      continue;
+
+    auto tmp = std::move(*cur);
+    Iter sift = cur;
+
+    do {
+      *sift = std::move(*(sift - 1));
+      --sift;
+    } while (sift != begin && comp(tmp, *(sift - 1)));
+
+    *sift = std::move(tmp);
+
+    if ((moved += cur - sift) > partial_insertion_sort_limit)
+      return false;
+  }
+
+  return true;
+}
+
+template <class Iter, class Comp>
+void sort2(Iter a, Iter b, Comp& comp) {
+  if (comp(*b, *a))
+    std::iter_swap(a, b);
+}
+
+template <class Iter, class Comp>
+void sort3(Iter a, Iter b, Iter c, Comp& comp) {
+  sort2(a, b, comp);
+  sort2(b, c, comp);
+  sort2(a, b, comp);
+}
+
+//
+// partition around *begin.
+//  left  = less than pivot
+//  right = greater or equal
+//
+// return = (position of pivot, was already partitioned)
+//
+template <class Iter, class Comp>
+std::pair<Iter, bool> partition_right(Iter begin, Iter end, Comp& comp) {
+  auto pivot = std::move(*begin);
+
+  Iter first = begin;
+  Iter last = end;
+
+  // median-of-3 guarantees an element >= pivot at end - 1.
+  while (comp(*++first, pivot))
+    ;
+
+  if (first - 1 == begin) {
+    while (first < last && !comp(*--last, pivot))
+      ;
+  }
+  else {
+    while (!comp(*--last, pivot))
+      ;
+  }
+
+  bool already_partitioned = first >= last;
+
+  while (first < last) {
+    std::iter_swap(first, last);
+
+    while (comp(*++first, pivot))
+      ;
+
+    while (!comp(*--last, pivot))
+      ;
+  }
+
+  Iter pivot_pos = first - 1;
+
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+
+  return {pivot_pos, already_partitioned};
+}
+
+//
+// partition around *begin, elements equal to pivot go to left.
+// used when there are many equal elements.
+//
+template <class Iter, class Comp>
+Iter partition_left(Iter begin, Iter end, Comp& comp) {
+  auto pivot = std::move(*begin);
+
+  Iter first = begin;
+  Iter last = end;
+
+  while (comp(pivot, *--last))
+    ;
+
+  if (last + 1 == end) {
+    while (first < last && !comp(pivot, *++first))
+      ;
+  }
+  else {
+    while (!comp(pivot, *++first))
+      ;
+  }
+
+  while (first < last) {
+    std::iter_swap(first, last);
+
+    while (comp(pivot, *--last))
+      ;
+
+    while (!comp(pivot, *++first))
+      ;
+  }
+
+  Iter pivot_pos = last;
+
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+
+  return pivot_pos;
+}
+
+template <class Iter, class Comp>
+void pdqsort_loop(Iter begin, Iter end, Comp& comp, int bad_allowed, bool leftmost) {
+  while (true) {
+    ptrdiff_t size = end - begin;
+
+    if (size < insertion_sort_threshold) {
+      if (leftmost)
+        insertion_sort(begin, end, comp);
+      else
+        unguarded_insertion_sort(begin, end, comp);
+
+      return;
+    }
+
+    ptrdiff_t s2 = size / 2;
+
+    if (size > ninther_threshold) {
+      sort3(begin, begin + s2, end - 1, comp);
+      sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+      sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+      std::iter_swap(begin, begin + s2);
+    }
+    else {
+      sort3(begin + s2, begin, end - 1, comp);
+    }
+
+    // pivot equals to the element before this range;
+    // every element equal to pivot is already in its final place.
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, comp) + 1;
+      continue;
+    }
+
+    auto [pivot_pos, already_partitioned] = partition_right(begin, end, comp);
+
+    ptrdiff_t l_size = pivot_pos - begin;
+    ptrdiff_t r_size = end - (pivot_pos + 1);
+
+    if (l_size < size / 8 || r_size < size / 8) {
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, comp);
+        std::sort_heap(begin, end, comp);
+        return;
+      }
+
+      // break up patterns
+      if (l_size >= insertion_sort_threshold) {
+        std::iter_swap(begin, begin + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+
+        if (l_size > ninther_threshold) {
+          std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+          std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+
+      if (r_size >= insertion_sort_threshold) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(end - 1, end - r_size / 4);
+
+        if (r_size > ninther_threshold) {
+          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          std::iter_swap(end - 2, end - (1 + r_size / 4));
+          std::iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+      }
+    }
+    else if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp) &&
+             partial_insertion_sort(pivot_pos + 1, end, comp)) {
+      return;
+    }
+
+    pdqsort_loop(begin, pivot_pos, comp, bad_allowed, leftmost);
+
+    begin = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+//
+// bottom-up merge sort of [data, data + n).
+// buf must have n elements.
+//
+// never reads out of range even if comp is not a strict weak ordering,
+// so this is used for user-defined comparators.
+//
+template <class T, class Comp>
+void merge_sort(T* data, T* buf, size_t n, Comp& comp) {
+  constexpr size_t run = 16;
+
+  for (size_t i = 0; i < n; i += run)
+    insertion_sort(data + i, data + std::min(i + run, n), comp);
+
+  T* src = data;
+  T* dest = buf;
+
+  for (size_t width = run; width < n; width *= 2) {
+    for (size_t i = 0; i < n; i += width * 2) {
+      size_t mid = std::min(i + width, n);
+      size_t hi = std::min(i + width * 2, n);
+
+      std::merge(std::make_move_iterator(src + i), std::make_move_iterator(src + mid),
+                 std::make_move_iterator(src + mid), std::make_move_iterator(src + hi),
+                 dest + i, comp);
+    }
+
+    std::swap(src, dest);
+  }
+
+  if (src != data)
+    std::move(src, src + n, data);
+}
+
+} // namespace detail
+
+template <class Iter, class Comp>
+void pdqsort(Iter begin, Iter end, Comp comp) {
+  if (end - begin < 2)
+    return;
+
+  detail::pdqsort_loop(begin, end, comp, std::bit_width(size_t(end - begin)), true);
+}
+
+template <class T, class Comp>
+void merge_sort(std::vector<T>& vec, Comp comp) {
+  std::vector<T> buf(vec.size());
+
+  detail::merge_sort(vec.data(), buf.data(), vec.size(), comp);
+}
+
+//
+// sort with multiple threads.
+//
+//  each thread sorts one chunk (pdqsort, or merge sort if stable),
+//  then sorted chunks are merged pairwise in parallel.
+//
+//  small inputs are sorted on the calling thread.
+//
+template <class T, class Comp>
+void parallel_sort(std::vector<T>& vec, Comp comp, bool stable = false) {
+  size_t const n = vec.size();
+
+  size_t threads = std::min<size_t>(std::thread::hardware_concurrency(),
+                                    n / detail::parallel_threshold);
+
+  if (threads < 2) {
+    if (stable)
+      merge_sort(vec, comp);
+    else
+      pdqsort(vec.begin(), vec.end(), comp);
+
+    return;
+  }
+
+  std::vector<T> buf(n);
+  std::vector<size_t> bounds;
+
+  for (size_t i = 0; i <= threads; i++)
+    bounds.emplace_back(n * i / threads);
+
+  {
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < threads; i++) {
+      workers.emplace_back([&, lo = bounds[i], hi = bounds[i + 1]] {
+        Comp c = comp;
+
+        if (stable)
+          detail::merge_sort(vec.data() + lo, buf.data() + lo, hi - lo, c);
+        else
+          pdqsort(vec.begin() + lo, vec.begin() + hi, c);
+      });
+    }
+
+    for (auto&& w : workers)
+      w.join();
+  }
+
+  T* src = vec.data();
+  T* dest = buf.data();
+
+  while (bounds.size() > 2) {
+    std::vector<size_t> next;
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+      size_t lo = bounds[i];
+      size_t mid = bounds[i + 1];
+      size_t hi = i + 2 < bounds.size() ? bounds[i + 2] : mid;
+
+      next.emplace_back(lo);
+
+      workers.emplace_back([=] {
+        Comp c = comp;
+
+        std::merge(std::make_move_iterator(src + lo), std::make_move_iterator(src + mid),
+                   std::make_move_iterator(src + mid), std::make_move_iterator(src + hi),
+                   dest + lo, c);
+      });
+    }
+
+    next.emplace_back(n);
+
+    for (auto&& w : workers)
+      w.join();
+
+    bounds = std::move(next);
+    std::swap(src, dest);
+  }
+
+  if (src != vec.data())
+    vec.swap(buf);
+}
+
+} // namespace fire::sort
@@ -29,57 +29,73 @@ struct SourceStorage {
   };
 
   std::string path;
-  std::string data;
 
-  std::unique_ptr<std::ifstream> file;
+  // contents of file. (mapped by mmap, read only)
+  //  followed by at least one '\0', so data.data()[data.length()] is readable.
+  std::string_view data;
 
-  std::vector<LineRange> line_range_list;
+  // offsets of first character of each line.
+  std::vector<u32> line_begins;
 
   std::vector<Token> token_list;
 
   bool Open();
   bool IsOpen() const;
 
+  LineRange GetLine(i64 index) const;
   LineRange GetLineRange(i64 position) const;
   std::string_view GetLineView(LineRange const& line) const;
   std::vector<LineRange> GetLinesOfAST(ASTPointer ast);
 
   std::string_view GetLineView(i64 index) const {
-    return this->GetLineView(this->line_range_list[index]);
+    return this->GetLineView(this->GetLine(index));
   }
 
   int Count() const {
-    return this->line_range_list.size();
+    return this->line_begins.size();
   }
 
   char operator[](size_t N) const {
-    return this->data[N];
+    return this->data.data()[N];
   }
 
   SourceStorage(std::string path);
+  ~SourceStorage();
+
+  SourceStorage(SourceStorage const&) = delete;
+  SourceStorage& operator=(SourceStorage const&) = delete;
+
+private:
+  void* mapped = nullptr;
+  size_t mapped_size = 0;
+
+  // used if file cannot be mapped. (pipe, etc)
+  std::string buffer;
+
+  void make_line_table();
 };
 
+//
+// SourceLocation
+//
+//  offset and length in source.
+//  line and column are not stored, they are resolved from offset only
+//  when needed. (by error messages, see SourceStorage::GetLineRange)
+//
 struct SourceLocation {
-  i64 position;
-  i64 length;
-  i64 pos_in_line;
+  u32 position;
+  u32 length;
 
   SourceStorage* ref;
-  SourceStorage::LineRange line;
 
-  std::string_view GetLine() const {
-    return this->ref->GetLineView(this->line);
+  SourceStorage::LineRange GetLineRange() const {
+    return this->ref->GetLineRange(this->position);
   }
 
   SourceLocation(i64 pos, i64 len, SourceStorage* r)
-      : position(pos),
-        length(len),
-        pos_in_line(0),
+      : position((u32)pos),
+        length((u32)len),
         ref(r) {
-    if (this->ref) {
-      this->line = this->ref->GetLineRange(this->position);
-      this->pos_in_line = this->position - this->line.begin;
-    }
   }
 
   SourceLocation()
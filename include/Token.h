@@ -23,36 +23,71 @@ enum class TokenKind : u8 {
   Punctuater,
 };
 
-struct Token {
-  i64 _index = 0;
+//
+// Keyword
+//
+//  identifiers which are keywords are classified by lexer. (see Lexer.cpp)
+//  kind of token is still Identifier (or Boolean for true / false),
+//  so parser can compare this instead of string.
+//
+enum class Keyword : u8 {
+  None,
+  Async,
+  Await,
+  Break,
+  Catch,
+  Class,
+  Continue,
+  Else,
+  Enum,
+  False,
+  Fn,
+  For,
+  If,
+  In,
+  Include,
+  Into,
+  Lambda,
+  Let,
+  Match,
+  Namespace,
+  Of,
+  Parallel,
+  Reduce,
+  Return,
+  Self,
+  Throw,
+  True,
+  Try,
+  While,
+  Yield,
+};
 
+struct Token {
   TokenKind kind;
+  Keyword keyword = Keyword::None;
+
+  // index in token_list of source
+  u32 _index = 0;
+
   std::string_view str;
   SourceLocation sourceloc;
 
   Token const* get_prev(int step = 1);
   Token const* get_next(int step = 1);
 
-  string& get_src_data() {
-    return this->sourceloc.ref->data;
-  }
-
   bool operator==(Token const& tok) const {
     return this->kind == tok.kind && this->str == tok.str;
   }
 
-  Token(TokenKind kind, std::string const& str, SourceLocation sourceloc = {})
+  Token(TokenKind kind, std::string_view str, SourceLocation sourceloc = {})
       : kind(kind),
         str(str),
         sourceloc(sourceloc) {
   }
 
-  Token(std::string str)
-      : Token(TokenKind::Unknown, str) {
-  }
-
   Token(char const* str = "")
-      : Token(std::string(str)) {
+      : Token(TokenKind::Unknown, str) {
   }
 
   Token(TokenKind kind)
@@ -19,6 +19,12 @@ enum class TypeKind : u8 {
   Tuple,
   Dict,
 
+  Thread,  // params[0] = result
+  Channel, // params[0] = element
+  Future,  // params[0] = result
+
+  Generator, // params[0] = element
+
   Enumerator,
   Instance, // instance of class
 
@@ -65,6 +71,9 @@ struct TypeInfo {
 
   bool is_iterable() const;
 
+  // can be used as key of dict
+  bool is_hashable() const;
+
   bool is_numeric() const;
   bool is_numeric_or_char() const;
 
@@ -78,14 +87,21 @@ struct TypeInfo {
 
   static TypeInfo make_instance_type(ASTPtr<AST::Class> ast);
 
-  static TypeKind from_name(string const& name);
-
-  static TypeKind from_name(string_view const& name) {
-    return from_name(string(name));
-  }
+  static TypeKind from_name(string_view name);
 
   static bool is_primitive_name(std::string_view);
 
+  //
+  // placeholder for type parameter of self object.
+  // (used in arguments of builtin member function)
+  //
+  //  ex: dict<K, V>::get(K key)  =>  K = make_self_param(0)
+  //
+  static TypeInfo make_self_param(int index);
+
+  // replace placeholders to params of self type
+  TypeInfo resolve_self_param(TypeInfo const& self) const;
+
   bool equals(TypeInfo const& type) const;
   std::string to_string() const;
 
@@ -95,4 +111,76 @@ struct TypeInfo {
   TypeInfo(TypeKind kind, std::vector<TypeInfo> params);
 };
 
+//
+// TypeId
+//
+//  handle of TypeInfo interned in global type table.
+//  every distinct TypeInfo (all fields) is stored once, so same types have
+//  same index. kind is copied into handle to avoid lookup.
+//
+//  TypeKind without params is interned at index of the kind, no lookup.
+//
+struct TypeId {
+  TypeKind kind = TypeKind::None;
+  u32 index = 0;
+
+  TypeId() = default;
+
+  TypeId(TypeKind kind)
+      : kind(kind),
+        index(static_cast<u32>(kind)) {
+  }
+
+  TypeId(TypeInfo const& type);
+
+  TypeInfo const& get() const;
+
+  TypeInfo const* operator->() const {
+    return &this->get();
+  }
+
+  operator TypeInfo const&() const {
+    return this->get();
+  }
+
+  bool operator==(TypeId const& t) const {
+    return this->index == t.index;
+  }
+
+  // same index is equal, else compare as TypeInfo. (for Unknown)
+  bool equals(TypeId const& t) const {
+    return this->index == t.index || this->get().equals(t.get());
+  }
+
+  bool equals(TypeInfo const& t) const {
+    return this->get().equals(t);
+  }
+
+  bool equals(TypeKind kind) const {
+    return this->equals(TypeId(kind));
+  }
+
+  bool is_numeric() const {
+    return this->kind == TypeKind::Int || this->kind == TypeKind::Float;
+  }
+
+  bool is_hashable() const {
+    return this->get().is_hashable();
+  }
+
+  std::string to_string() const {
+    return this->get().to_string();
+  }
+
+  // count of interned types
+  static size_t count();
+
+  //
+  // remove types which refer to nodes of arena. (called when arena is freed)
+  // their entries are cleared, and never returned by intern again.
+  // handles of them must not be used after this.
+  //
+  static void forget(AST::Arena const& arena);
+};
+
 } // namespace fire
\ No newline at end of file
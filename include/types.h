@@ -1,13 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #define _DBG_DONT_USE_SMART_PTR_ 0
 
+#define FIRE_VERSION "0.0.1"
+
 using i8 = std::int8_t;
 using i16 = std::int16_t;
 using i32 = std::int32_t;
@@ -46,10 +50,15 @@ struct TypeInfo;
 struct Object;
 struct ObjPrimitive;
 struct ObjIterable;
+struct ObjTuple;
 struct ObjString;
 struct ObjEnumerator;
 struct ObjInstance;
 struct ObjCallable;
+struct ObjThread;
+struct ObjChannel;
+struct ObjFuture;
+struct ObjGenerator;
 struct ObjModule;
 struct ObjType;
 
@@ -96,6 +105,8 @@ struct Signature;
 
 // struct Namespace;
 
+class Arena;
+
 } // namespace AST
 
 namespace builtins {
@@ -119,52 +130,202 @@ using ObjPointer = Object*;
 template <class T>
 using ObjPtr = T*;
 
-using ASTPointer = AST::Base*;
-
-template <class T>
-using ASTPtr = T*;
-
 template <class T, class... Args>
 T* ObjNew(Args&&... args) {
   return new T(std::forward<Args>(args)...);
 }
 
+#else
+namespace gc {
+// object of which count became zero while frozen. (see Object::is_frozen)
+void defer_delete(Object* obj);
+} // namespace gc
+
+//
+// ObjRef
+//  intrusive pointer to Object. (count is Object::ref_count)
+//  not thread-safe: count is changed without atomic operation,
+//  except objects shared by threads of parallel for. (see Object::is_frozen)
+//
 template <class T>
-ASTPtr<T> ASTCast(ASTPointer p) {
-  return (T*)p;
-}
+class ObjRef {
+  template <class U>
+  friend class ObjRef;
+
+  T* ptr = nullptr;
+
+  void retain() const {
+    if (!this->ptr)
+      return;
+
+    if (this->ptr->is_frozen) [[unlikely]]
+      std::atomic_ref(this->ptr->ref_count).fetch_add(1, std::memory_order_relaxed);
+    else
+      this->ptr->ref_count++;
+  }
+
+  void release() {
+    if (!this->ptr)
+      return;
+
+    if (this->ptr->is_frozen) [[unlikely]] {
+      if (std::atomic_ref(this->ptr->ref_count).fetch_sub(1, std::memory_order_acq_rel) ==
+          1)
+        gc::defer_delete(this->ptr);
+    }
+    else if (--this->ptr->ref_count == 0)
+      delete this->ptr;
+  }
+
+public:
+  ObjRef() = default;
+
+  ObjRef(std::nullptr_t) {
+  }
+
+  explicit ObjRef(T* p)
+      : ptr(p) {
+    this->retain();
+  }
+
+  ObjRef(ObjRef const& other)
+      : ptr(other.ptr) {
+    this->retain();
+  }
+
+  ObjRef(ObjRef&& other) noexcept
+      : ptr(other.ptr) {
+    other.ptr = nullptr;
+  }
+
+  template <class U>
+    requires std::is_convertible_v<U*, T*>
+  ObjRef(ObjRef<U> const& other)
+      : ptr(other.ptr) {
+    this->retain();
+  }
+
+  template <class U>
+    requires std::is_convertible_v<U*, T*>
+  ObjRef(ObjRef<U>&& other) noexcept
+      : ptr(other.ptr) {
+    other.ptr = nullptr;
+  }
+
+  ~ObjRef() {
+    this->release();
+  }
+
+  ObjRef& operator=(ObjRef const& other) {
+    ObjRef(other).swap(*this);
+    return *this;
+  }
+
+  ObjRef& operator=(ObjRef&& other) noexcept {
+    ObjRef(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ObjRef& operator=(std::nullptr_t) {
+    this->reset();
+    return *this;
+  }
+
+  // take the reference of other, without changing count.
+  template <class U>
+  static ObjRef StaticCast(ObjRef<U>&& other) {
+    ObjRef ret;
+
+    ret.ptr = static_cast<T*>(other.ptr);
+    other.ptr = nullptr;
+
+    return ret;
+  }
+
+  void reset() {
+    this->release();
+    this->ptr = nullptr;
+  }
+
+  void swap(ObjRef& other) noexcept {
+    std::swap(this->ptr, other.ptr);
+  }
+
+  T* get() const {
+    return this->ptr;
+  }
+
+  T& operator*() const {
+    return *this->ptr;
+  }
+
+  T* operator->() const {
+    return this->ptr;
+  }
+
+  explicit operator bool() const {
+    return this->ptr != nullptr;
+  }
+
+  long use_count() const {
+    return this->ptr ? (long)this->ptr->ref_count : 0;
+  }
+
+  template <class U>
+  bool operator==(ObjRef<U> const& other) const {
+    return this->ptr == other.ptr;
+  }
+
+  bool operator==(std::nullptr_t) const {
+    return this->ptr == nullptr;
+  }
+};
 
-#else
 template <class T, class U>
-std::shared_ptr<T> PtrCast(std::shared_ptr<U> p) {
-  return std::static_pointer_cast<T>(p);
+ObjRef<T> PtrCast(ObjRef<U> p) {
+  return ObjRef<T>::StaticCast(std::move(p));
 }
 
 template <class T, class U>
-std::shared_ptr<T> PtrDynamicCast(std::shared_ptr<U> p) {
-  return std::dynamic_pointer_cast<T>(p);
+ObjRef<T> PtrDynamicCast(ObjRef<U> const& p) {
+  return ObjRef<T>(dynamic_cast<T*>(p.get()));
 }
 
-using ObjPointer = std::shared_ptr<Object>;
+using ObjPointer = ObjRef<Object>;
 
 template <class T>
-using ObjPtr = std::shared_ptr<T>;
+using ObjPtr = ObjRef<T>;
 
-using ASTPointer = std::shared_ptr<AST::Base>;
-
-template <class T>
-using ASTPtr = std::shared_ptr<T>;
+namespace gc {
+void track(Object* obj);
+void untrack(Object* obj);
+} // namespace gc
 
 template <class T, class... Args>
-std::shared_ptr<T> ObjNew(Args&&... args) {
-  return std::make_shared<T>(std::forward<Args>(args)...);
+ObjRef<T> ObjNew(Args&&... args) {
+  auto obj = new T(std::forward<Args>(args)...);
+
+  if constexpr (T::is_traced)
+    gc::track(obj);
+
+  return ObjRef<T>(obj);
 }
 
+#endif
+
+//
+// AST nodes are allocated in arena, and freed together with it.
+//  (nodes don't own each other, see AST::Arena)
+//
+using ASTPointer = AST::Base*;
+
+template <class T>
+using ASTPtr = T*;
+
 template <class T>
 ASTPtr<T> ASTCast(ASTPointer p) {
-  return std::static_pointer_cast<T>(p);
+  return static_cast<T*>(p);
 }
-#endif
 
 using ObjVector = std::vector<ObjPointer>;
 using ASTVector = std::vector<ASTPointer>;
@@ -1,15 +1,12 @@
 #include "AST.h"
+#include "Object.h"
 #include "alert.h"
 
 namespace fire::AST {
 
 template <class T, class... Args>
 ASTPtr<T> ASTNew(Args&&... args) {
-#if _DBG_DONT_USE_SMART_PTR_
-  return new T(std::forward<Args>(args)...);
-#else
-  return std::make_shared<T>(std::forward<Args>(args)...);
-#endif
+  return Arena::current().New<T>(std::forward<Args>(args)...);
 }
 
 bool Base::is(ASTKind k) {
@@ -118,6 +115,18 @@ ASTPtr<Identifier> Identifier::New(Token tok) {
   return ASTNew<Identifier>(tok);
 }
 
+TypeInfo Identifier::get_ft_type() const {
+  TypeInfo type = TypeKind::Function;
+
+  type.params.reserve(this->ft_args.size() + 1);
+  type.params.emplace_back(this->ft_ret);
+
+  for (auto&& t : this->ft_args)
+    type.params.emplace_back(t);
+
+  return type;
+}
+
 ASTPtr<ScopeResol> ScopeResol::New(ASTPtr<Identifier> first) {
   return ASTNew<ScopeResol>(first);
 }
@@ -132,11 +141,7 @@ ASTPointer ScopeResol::Clone() const {
 }
 
 Identifier* ScopeResol::GetID() {
-#if _DBG_DONT_USE_SMART_PTR_
   return *idlist.rbegin();
-#else
-  return idlist.rbegin()->get();
-#endif
 }
 
 ASTPtr<Identifier> ScopeResol::GetLastID() const {
@@ -165,6 +170,40 @@ Array::Array(Token tok)
     : Base(ASTKind::Array, tok) {
 }
 
+ASTPtr<Tuple> Tuple::New(Token tok) {
+  return ASTNew<Tuple>(tok);
+}
+
+ASTPointer Tuple::Clone() const {
+  auto x = New(this->token);
+
+  for (ASTPointer const& e : this->elements)
+    x->elements.emplace_back(e->Clone());
+
+  return x;
+}
+
+Tuple::Tuple(Token tok)
+    : Base(ASTKind::Tuple, tok) {
+}
+
+ASTPtr<Dict> Dict::New(Token tok) {
+  return ASTNew<Dict>(tok);
+}
+
+ASTPointer Dict::Clone() const {
+  auto x = New(this->token);
+
+  for (auto&& [k, v] : this->elements)
+    x->elements.emplace_back(k->Clone(), v->Clone());
+
+  return x;
+}
+
+Dict::Dict(Token tok)
+    : Base(ASTKind::Dict, tok) {
+}
+
 ASTPtr<CallFunc> CallFunc::New(ASTPointer expr, ASTVector args) {
   return ASTNew<CallFunc>(expr, std::move(args));
 }
@@ -264,6 +303,19 @@ ASTPtr<Statement> Statement::NewWhile(Token tok, ASTPointer cond, ASTPtr<Block>
   return ASTNew<Statement>(ASTKind::While, tok, new While{cond, block});
 }
 
+ASTPtr<Statement> Statement::NewForEach(Token tok, Token varname, ASTPointer iterable,
+                                        ASTPtr<Block> block) {
+  return ASTNew<Statement>(ASTKind::ForEach, tok,
+                           new ForEach{varname, iterable, block, {}});
+}
+
+ASTPtr<Statement> Statement::NewParallelFor(Token tok, Token varname, ASTPointer begin,
+                                            ASTPointer end, ASTPtr<Block> block,
+                                            ASTKind op, ASTPointer acc) {
+  return ASTNew<Statement>(ASTKind::ParallelFor, tok,
+                           new ParallelFor{varname, begin, end, block, op, acc});
+}
+
 ASTPtr<Statement> Statement::NewTryCatch(Token tok, ASTPtr<Block> tryblock,
                                          vector<TryCatch::Catcher> catchers) {
   return ASTNew<Statement>(ASTKind::TryCatch, tok,
@@ -302,6 +354,14 @@ Statement::~Statement() {
     delete this->data_while;
     break;
 
+  case ASTKind::ForEach:
+    delete this->data_for_each;
+    break;
+
+  case ASTKind::ParallelFor:
+    delete this->data_parallel_for;
+    break;
+
   case ASTKind::TryCatch:
     delete this->data_try_catch;
     break;
@@ -319,6 +379,14 @@ ASTPointer Match::Clone() const {
   return ast;
 }
 
+size_t Match::KeyHash::operator()(ObjPointer const& key) const {
+  return key->Hash();
+}
+
+bool Match::KeyEqual::operator()(ObjPointer const& a, ObjPointer const& b) const {
+  return a->Equals(b);
+}
+
 ASTPtr<Match> Match::New(Token tok, ASTPointer cond, Vec<Pattern> patterns) {
   return ASTNew<Match>(tok, cond, std::move(patterns));
 }
@@ -388,6 +456,8 @@ ASTPointer Function::Clone() const {
 
   x->block = ASTCast<Block>(this->block->Clone());
   x->is_var_arg = this->is_var_arg;
+  x->is_async = this->is_async;
+  x->is_generator = this->is_generator;
 
   return x;
 }
@@ -422,6 +492,10 @@ ASTPointer Enum::Clone() const {
 
 Enum::Enum(Token tok, Token name)
     : Templatable(ASTKind::Enum, tok, name) {
+  TypeInfo type = TypeKind::Enumerator;
+
+  type.name = this->GetName();
+  this->enumerator_type = type;
 }
 
 ASTPtr<Class> Class::New(Token tok, Token name) {
@@ -456,6 +530,10 @@ Class::Class(Token tok, Token name, ASTVec<VarDef> member_variables,
     : Templatable(ASTKind::Class, tok, name),
       member_variables(std::move(member_variables)),
       member_functions(std::move(member_functions)) {
+  TypeInfo type = TypeKind::Instance;
+
+  type.name = this->GetName();
+  this->instance_type = type;
 }
 
 ASTPointer Identifier::Clone() const {
@@ -486,9 +564,13 @@ ASTPointer TypeName::Clone() const {
 }
 
 ASTPointer VarDef::Clone() const {
-  return New(this->token, this->name,
-             ASTCast<TypeName>(this->type ? this->type->Clone() : nullptr),
-             this->init ? this->init->Clone() : nullptr);
+  auto x = New(this->token, this->name,
+               ASTCast<TypeName>(this->type ? this->type->Clone() : nullptr),
+               this->init ? this->init->Clone() : nullptr);
+
+  x->unpack = CloneASTVec<VarDef>(this->unpack);
+
+  return x;
 }
 
 ASTPointer Statement::Clone() const {
@@ -516,12 +598,28 @@ ASTPointer Statement::Clone() const {
                     ASTCast<AST::Block>(d->block->Clone()));
   }
 
+  case ASTKind::ForEach: {
+    auto d = this->data_for_each;
+
+    return NewForEach(this->token, d->varname, d->iterable->Clone(),
+                      ASTCast<AST::Block>(d->block->Clone()));
+  }
+
+  case ASTKind::ParallelFor: {
+    auto d = this->data_parallel_for;
+
+    return NewParallelFor(this->token, d->varname, d->begin->Clone(), d->end->Clone(),
+                          ASTCast<AST::Block>(d->block->Clone()), d->op,
+                          d->acc ? d->acc->Clone() : nullptr);
+  }
+
   case ASTKind::Break:
   case ASTKind::Continue:
     return New(this->kind, this->token, nullptr);
 
   case ASTKind::Throw:
   case ASTKind::Return:
+  case ASTKind::Yield:
     break;
 
   default:
@@ -26,6 +26,9 @@ void walk_ast(ASTPointer ast, std::function<void(ASTWalkerLocation, ASTPointer)>
 
   case Kind::Variable:
   case Kind::FuncName:
+  case Kind::BuiltinFuncName:
+  case Kind::ClassName:
+  case Kind::EnumName:
   case Kind::Enumerator:
     if (ast->_constructed_as == Kind::ScopeResol)
       goto _label_scope_resol;
@@ -48,7 +51,9 @@ void walk_ast(ASTPointer ast, std::function<void(ASTWalkerLocation, ASTPointer)>
     break;
   }
 
-  case Kind::CallFunc: {
+  case Kind::CallFunc:
+  case Kind::CallFunc_Ctor:
+  case Kind::CallFunc_Enumerator: {
     auto x = ASTCast<AST::CallFunc>(ast);
 
     walk_ast(x->callee, fn);
@@ -68,7 +73,26 @@ void walk_ast(ASTPointer ast, std::function<void(ASTWalkerLocation, ASTPointer)>
     break;
   }
 
+  case Kind::Tuple: {
+    for (auto&& y : ast->As<AST::Tuple>()->elements)
+      walk_ast(y, fn);
+
+    break;
+  }
+
+  case Kind::Dict: {
+    auto x = ast->As<AST::Dict>();
+
+    for (auto&& [k, v] : x->elements) {
+      walk_ast(k, fn);
+      walk_ast(v, fn);
+    }
+
+    break;
+  }
+
   case Kind::Block:
+  case Kind::Namespace:
     for (auto&& x : ast->As<AST::Block>()->list)
       walk_ast(x, fn);
 
@@ -105,11 +129,32 @@ void walk_ast(ASTPointer ast, std::function<void(ASTWalkerLocation, ASTPointer)>
     break;
   }
 
+  case Kind::ForEach: {
+    auto d = ast->As<AST::Statement>()->data_for_each;
+
+    walk_ast(d->iterable, fn);
+    walk_ast(d->block, fn);
+
+    break;
+  }
+
+  case Kind::ParallelFor: {
+    auto d = ast->As<AST::Statement>()->data_parallel_for;
+
+    walk_ast(d->begin, fn);
+    walk_ast(d->end, fn);
+    walk_ast(d->acc, fn);
+    walk_ast(d->block, fn);
+
+    break;
+  }
+
   case Kind::Break:
   case Kind::Continue:
     break;
 
   case Kind::Return:
+  case Kind::Yield:
   case Kind::Throw:
     walk_ast(ast->As<AST::Statement>()->expr, fn);
     break;
@@ -132,7 +177,21 @@ void walk_ast(ASTPointer ast, std::function<void(ASTWalkerLocation, ASTPointer)>
     break;
   }
 
-  case Kind::Function: {
+  case Kind::Match: {
+    auto x = ASTCast<AST::Match>(ast);
+
+    walk_ast(x->cond, fn);
+
+    for (auto&& P : x->patterns) {
+      walk_ast(P.expr, fn);
+      walk_ast(P.block, fn);
+    }
+
+    break;
+  }
+
+  case Kind::Function:
+  case Kind::LambdaFunc: {
     auto x = ast->As<AST::Function>();
 
     for (auto&& y : x->arguments)
@@ -144,6 +203,21 @@ void walk_ast(ASTPointer ast, std::function<void(ASTWalkerLocation, ASTPointer)>
     break;
   }
 
+  case Kind::Enum:
+    break;
+
+  case Kind::Class: {
+    auto x = ast->As<AST::Class>();
+
+    for (auto&& mv : x->member_variables)
+      walk_ast(mv, fn);
+
+    for (auto&& mf : x->member_functions)
+      walk_ast(mf, fn);
+
+    break;
+  }
+
   case Kind::TypeName: {
     auto x = ASTCast<AST::TypeName>(ast);
 
@@ -0,0 +1,67 @@
+#include <new>
+
+#include "AST.h"
+#include "alert.h"
+
+namespace fire::AST {
+
+static thread_local Arena* g_current = nullptr;
+
+Arena::Scope::Scope(Arena& arena)
+    : prev(g_current) {
+  g_current = &arena;
+}
+
+Arena::Scope::~Scope() {
+  g_current = this->prev;
+}
+
+Arena::~Arena() {
+  // interned types refer to Enum and Class nodes.
+  TypeId::forget(*this);
+
+  for (auto it = this->nodes.rbegin(); it != this->nodes.rend(); it++)
+    (*it)->~Base();
+
+  for (auto&& chunk : this->chunks)
+    ::operator delete(chunk.begin);
+}
+
+bool Arena::contains(void const* p) const {
+  for (auto&& chunk : this->chunks)
+    if (p >= chunk.begin && p < chunk.end)
+      return true;
+
+  return false;
+}
+
+Arena& Arena::current() {
+  if (g_current)
+    return *g_current;
+
+  // nodes made out of any scope live until exit.
+  static Arena* global = new Arena();
+
+  return *global;
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+  auto p = (char*)(((uintptr_t)this->ptr + align - 1) & ~(uintptr_t)(align - 1));
+
+  if (!this->ptr || p + size > this->end) {
+    auto n = std::max(ChunkSize, size + align);
+
+    this->ptr = (char*)::operator new(n);
+    this->end = this->ptr + n;
+
+    this->chunks.push_back({this->ptr, this->end});
+
+    p = (char*)(((uintptr_t)this->ptr + align - 1) & ~(uintptr_t)(align - 1));
+  }
+
+  this->ptr = p + size;
+
+  return p;
+}
+
+} // namespace fire::AST
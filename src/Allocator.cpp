@@ -0,0 +1,87 @@
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+
+#include "Allocator.h"
+
+namespace fire::alloc {
+
+thread_local Pool pool;
+
+// free blocks released by finished threads
+static std::mutex g_orphan_mtx;
+static FreeBlock* g_orphans[ClassCount];
+
+void* refill(SizeClass& sc, size_t block_size) {
+  auto index = class_index(block_size);
+
+  // once per slab, lock is not costly
+  {
+    std::lock_guard lock(g_orphan_mtx);
+
+    if (auto block = g_orphans[index]; block) {
+      g_orphans[index] = nullptr;
+      sc.free_list = block->next;
+
+      return block;
+    }
+  }
+
+  auto slab = static_cast<u8*>(::operator new(SlabSize));
+  size_t count = SlabSize / block_size;
+
+  // first block is returned, others are linked to free list
+  for (size_t i = count - 1; i >= 1; i--) {
+    auto block = reinterpret_cast<FreeBlock*>(slab + i * block_size);
+
+    block->next = sc.free_list;
+    sc.free_list = block;
+  }
+
+  sc.slabs++;
+
+  return slab;
+}
+
+void release_thread() {
+  std::lock_guard lock(g_orphan_mtx);
+
+  for (size_t i = 0; i < ClassCount; i++) {
+    auto& sc = pool.classes[i];
+
+    while (auto block = sc.free_list) {
+      sc.free_list = block->next;
+
+      block->next = g_orphans[i];
+      g_orphans[i] = block;
+    }
+  }
+}
+
+void print_stats() {
+  size_t total = 0, slabs = 0;
+
+  std::cerr << "alloc: size    allocated        freed    live  slabs" << std::endl;
+
+  for (size_t i = 0; i < ClassCount; i++) {
+    auto& sc = pool.classes[i];
+
+    if (sc.allocated == 0)
+      continue;
+
+    std::cerr << "alloc: " << std::setw(4) << (i + 1) * Granularity << std::setw(13)
+              << sc.allocated << std::setw(13) << sc.freed << std::setw(8)
+              << sc.allocated - sc.freed << std::setw(7) << sc.slabs << std::endl;
+
+    total += sc.allocated;
+    slabs += sc.slabs;
+  }
+
+  std::cerr << "alloc: >256" << std::setw(13) << pool.large_allocated << std::setw(13)
+            << pool.large_freed << std::setw(8) << pool.large_allocated - pool.large_freed
+            << std::endl
+            << "alloc: pooled = " << total << " (" << slabs * SlabSize / 1024
+            << " KiB in " << slabs << " slabs)" << std::endl;
+}
+
+} // namespace fire::alloc
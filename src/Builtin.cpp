@@ -1,5 +1,13 @@
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <bit>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "Lexer.h"
 #include "Parser.h"
@@ -8,6 +16,10 @@
 #include "AST.h"
 #include "Builtin.h"
 #include "Object.h"
+#include "Sort.h"
+#include "GC.h"
+#include "Channel.h"
+#include "EventLoop.h"
 
 #include "Error.h"
 
@@ -98,12 +110,471 @@ define_builtin_func(Length) {
   auto content = args[0];
 
   if (content->is_string() || content->is_vector()) {
-    return ObjNew<ObjPrimitive>((i64)content->As<ObjString>()->list.size());
+    return ObjNew<ObjPrimitive>((i64)content->As<ObjIterable>()->Count());
+  }
+
+  if (content->is_dict()) {
+    return ObjNew<ObjPrimitive>((i64)content->As<ObjDict>()->Count());
+  }
+
+  todo_impl;
+}
+
+// dict.get(key, default)
+define_builtin_func(Dict_Get) {
+  if (auto pval = args[0]->As<ObjDict>()->Find(args[1]); pval)
+    return *pval;
+
+  return args[2];
+}
+
+define_builtin_func(Dict_Insert) {
+  args[0]->As<ObjDict>()->Insert(args[1], args[2]);
+
+  return ObjNew<ObjNone>();
+}
+
+define_builtin_func(Dict_Remove) {
+  return ObjNew<ObjPrimitive>(args[0]->As<ObjDict>()->Remove(args[1]));
+}
+
+define_builtin_func(Dict_Contains) {
+  return ObjNew<ObjPrimitive>(args[0]->As<ObjDict>()->Find(args[1]) != nullptr);
+}
+
+define_builtin_func(Dict_Keys) {
+  auto dict = args[0]->As<ObjDict>();
+
+  auto keys = ObjNew<ObjIterable>(TypeInfo(TypeKind::Vector, {dict->type->params[0]}));
+
+  keys->list = dict->Keys();
+
+  return keys;
+}
+
+// ----------------------------
+//  sort
+
+enum class SortMode {
+  Unstable,
+  Stable,
+  Partial,
+};
+
+//
+// primitive as unsigned integer with same order.
+//
+static u64 sort_key(Object const* obj) {
+  auto p = obj->As<ObjPrimitive>();
+
+  switch (obj->type.kind) {
+  case TypeKind::Int:
+    return static_cast<u64>(p->vi) ^ (1ull << 63);
+
+  case TypeKind::Float: {
+    auto bits = std::bit_cast<u64>(p->vf);
+
+    return (bits >> 63) ? ~bits : bits | (1ull << 63);
+  }
+
+  case TypeKind::Char:
+    return p->vc;
+
+  case TypeKind::Bool:
+    return p->vb;
   }
 
   todo_impl;
 }
 
+template <class T, class Comp>
+static void sort_keys(std::vector<T>& keys, SortMode mode, size_t count, Comp comp) {
+  switch (mode) {
+  case SortMode::Unstable:
+  case SortMode::Stable:
+    sort::parallel_sort(keys, comp, mode == SortMode::Stable);
+    break;
+
+  case SortMode::Partial:
+    std::partial_sort(keys.begin(), keys.begin() + count, keys.end(), comp);
+    break;
+  }
+}
+
+//
+// sort elements of vector with native comparison.
+//
+//  keys are paired with original index, so equal elements keep their order.
+//  (any mode is stable)
+//
+static void sort_vector(ASTPtr<AST::CallFunc> ast, ObjIterable* vec, SortMode mode,
+                        size_t count = 0) {
+  if (vec->is_columnar())
+    throw Error(ast, "cannot sort vector of class instances, use sort_by()");
+
+  auto& list = vec->list;
+
+  if (list.size() < 2)
+    return;
+
+  ObjVector sorted;
+  sorted.reserve(list.size());
+
+  switch (list[0]->type.kind) {
+  case TypeKind::Int:
+  case TypeKind::Float:
+  case TypeKind::Char:
+  case TypeKind::Bool: {
+    std::vector<std::pair<u64, u32>> keys;
+    keys.reserve(list.size());
+
+    for (u32 i = 0; auto&& e : list)
+      keys.emplace_back(sort_key(e.get()), i++);
+
+    sort_keys(keys, mode, count, std::less<>());
+
+    for (auto&& [k, i] : keys)
+      sorted.emplace_back(std::move(list[i]));
+
+    break;
+  }
+
+  case TypeKind::String: {
+    std::vector<std::u16string> strs;
+    std::vector<u32> keys;
+
+    strs.reserve(list.size());
+    keys.reserve(list.size());
+
+    for (u32 i = 0; auto&& e : list) {
+      auto& s = strs.emplace_back();
+
+      for (auto&& c : e->As<ObjString>()->list)
+        s.push_back(c->As<ObjPrimitive>()->vc);
+
+      keys.emplace_back(i++);
+    }
+
+    sort_keys(keys, mode, count, [&strs](u32 a, u32 b) {
+      int c = strs[a].compare(strs[b]);
+      return c != 0 ? c < 0 : a < b;
+    });
+
+    for (u32 i : keys)
+      sorted.emplace_back(std::move(list[i]));
+
+    break;
+  }
+
+  default:
+    throw Error(ast->callee, "cannot compare elements of '" + vec->type.to_string() +
+                                 "', use sort_by() with comparator");
+  }
+
+  list = std::move(sorted);
+}
+
+define_builtin_func(Vector_Sort) {
+  sort_vector(ast, args[0]->As<ObjIterable>(), SortMode::Unstable);
+
+  return ObjNew<ObjNone>();
+}
+
+define_builtin_func(Vector_StableSort) {
+  sort_vector(ast, args[0]->As<ObjIterable>(), SortMode::Stable);
+
+  return ObjNew<ObjNone>();
+}
+
+// sort only first n elements. (whole vector if n is more than length)
+define_builtin_func(Vector_PartialSort) {
+  auto vec = args[0]->As<ObjIterable>();
+  auto n = args[1]->As<ObjPrimitive>()->vi;
+
+  if (n < 0)
+    throw Error(ast->args[1], "out of range");
+
+  sort_vector(ast, vec, SortMode::Partial, std::min((size_t)n, vec->Count()));
+
+  return ObjNew<ObjNone>();
+}
+
+//
+// sort_by(fn(a, b) -> bool)
+//  fn returns true if a should be placed before b.
+//
+define_builtin_func(Vector_SortBy) {
+  auto vec = args[0]->As<ObjIterable>();
+  auto& list = vec->list;
+  auto callable = args[1]->As<ObjCallable>();
+
+  auto ev = eval::Evaluator::GetInstance();
+
+  auto comp = [&](ObjPointer const& a, ObjPointer const& b) {
+    ObjVector xargs = {a, b};
+
+    if (callable->builtin)
+      return callable->builtin->Call(ast, std::move(xargs))->get_vb();
+
+    return ev->call_function(callable->func, std::move(xargs), ast)->get_vb();
+  };
+
+  // merge sort: user function may not be a strict weak ordering.
+  if (vec->is_columnar()) {
+    ObjVector rows;
+
+    for (size_t i = 0; i < vec->Count(); i++)
+      rows.emplace_back(vec->At(i));
+
+    sort::merge_sort(rows, comp);
+
+    Columns sorted{vec->columns->ast};
+
+    for (auto&& r : rows)
+      sorted.Append(PtrCast<ObjInstance>(r));
+
+    *vec->columns = std::move(sorted);
+
+    return ObjNew<ObjNone>();
+  }
+
+  ObjVector temp = list;
+
+  sort::merge_sort(temp, comp);
+
+  list = std::move(temp);
+
+  return ObjNew<ObjNone>();
+}
+
+// vector<T>.to_columns()
+define_builtin_func(Vector_ToColumns) {
+  if (!args[0]->As<ObjIterable>()->ToColumns())
+    throw Error(ast, "to_columns() requires vector of class instances");
+
+  return ObjNew<ObjNone>();
+}
+
+// vector<T>.to_rows()
+define_builtin_func(Vector_ToRows) {
+  args[0]->As<ObjIterable>()->ToRows();
+
+  return ObjNew<ObjNone>();
+}
+
+// run gc now, return count of freed objects
+define_builtin_func(GC_Collect) {
+  return ObjNew<ObjPrimitive>((i64)gc::collect());
+}
+
+//
+// spawn(callable, args...) -> thread<T>
+//  run callable(args...) on new thread.
+//
+define_builtin_func(Spawn) {
+  if (!args[0]->is_callable())
+    throw Error(ast->args[0], "expected callable object");
+
+  auto callable = PtrCast<ObjCallable>(args[0]);
+  auto const& params = callable->type->params;
+
+  bool is_var_arg =
+      callable->builtin ? callable->builtin->is_variable_args : callable->func->is_var_arg;
+
+  size_t argc = params.size() - 1;
+
+  args.erase(args.begin());
+
+  if (args.size() < argc)
+    throw Error(ast, "too few arguments");
+
+  if (!is_var_arg && args.size() > argc)
+    throw Error(ast, "too many arguments");
+
+  for (size_t i = 0; i < argc; i++) {
+    if (!args[i]->type.equals(params[i + 1]))
+      throw Error(ast->args[i + 1], "expected '" + params[i + 1].to_string() +
+                                        "' type object, but found '" +
+                                        args[i]->type.to_string() + "'");
+  }
+
+  return eval::Evaluator::GetInstance()->spawn(callable, std::move(args), ast);
+}
+
+// thread<T>.join() -> T
+define_builtin_func(Thread_Join) {
+  return args[0]->As<ObjThread>()->Join(ast);
+}
+
+//
+// make_channel() -> channel<T>
+// make_channel(capacity) -> channel<T>
+//  T is given by type of variable. (let ch: channel<int> = make_channel(16);)
+//  without capacity, channel is unbounded.
+//
+define_builtin_func(MakeChannel) {
+  i64 capacity = args.empty() ? 0 : args[0]->As<ObjPrimitive>()->vi;
+
+  if (capacity < 0 || (!args.empty() && capacity == 0))
+    throw Error(ast->args[0], "capacity of channel must be greater than 0");
+
+  return ObjNew<ObjChannel>(TypeInfo(TypeKind::Channel, {TypeKind::Unknown}),
+                            std::make_shared<Channel>(capacity));
+}
+
+// channel<T>.send(T)
+//  wait while channel is full.
+define_builtin_func(Channel_Send) {
+  args[0]->As<ObjChannel>()->Send(std::move(args[1]), ast);
+
+  return ObjNew<ObjNone>();
+}
+
+// channel<T>.recv() -> T
+//  wait while channel is empty.
+define_builtin_func(Channel_Recv) {
+  auto obj = args[0]->As<ObjChannel>()->Recv();
+
+  if (!obj)
+    throw Error(ast, "receive from closed channel");
+
+  return obj;
+}
+
+// channel<T>.close()
+//  objects in channel are still received.
+define_builtin_func(Channel_Close) {
+  args[0]->As<ObjChannel>()->channel->Close();
+
+  return ObjNew<ObjNone>();
+}
+
+//
+// async I/O
+//  result is future, taken by await. (see io::EventLoop)
+//
+
+// sleep_async(ms) -> future<none>
+define_builtin_func(SleepAsync) {
+  auto state = std::make_shared<io::FutureState>();
+
+  io::EventLoop::get().add_timer(args[0]->As<ObjPrimitive>()->vi,
+                                 [state] { state->resolve(ObjNew<ObjNone>()); });
+
+  return ObjNew<ObjFuture>(TypeInfo(TypeKind::Future, {TypeKind::None}), state);
+}
+
+// read_file_async(path) -> future<string>
+define_builtin_func(ReadFileAsync) {
+  auto state = std::make_shared<io::FutureState>();
+
+  auto path = args[0]->ToString();
+  auto data = std::make_shared<std::string>();
+  auto ok = std::make_shared<bool>(false);
+
+  io::EventLoop::get().run_in_worker(
+      [path, data, ok] {
+        std::ifstream ifs{path, std::ios::binary};
+
+        if (ifs.is_open()) {
+          data->assign(std::istreambuf_iterator<char>(ifs), {});
+          *ok = true;
+        }
+      },
+      [state, path, data, ok, ast] {
+        if (*ok)
+          state->resolve(ObjNew<ObjString>(*data));
+        else
+          state->reject(std::make_exception_ptr(
+              Error(ast, "cannot open file '" + path + "'")));
+      });
+
+  return ObjNew<ObjFuture>(TypeInfo(TypeKind::Future, {TypeKind::String}), state);
+}
+
+// write_file_async(path, data) -> future<int>
+//  result = written bytes
+define_builtin_func(WriteFileAsync) {
+  auto state = std::make_shared<io::FutureState>();
+
+  auto path = args[0]->ToString();
+  auto data = std::make_shared<std::string>(args[1]->ToString());
+  auto ok = std::make_shared<bool>(false);
+
+  io::EventLoop::get().run_in_worker(
+      [path, data, ok] {
+        std::ofstream ofs{path, std::ios::binary};
+
+        *ok = ofs.is_open() && ofs.write(data->data(), (std::streamsize)data->size());
+      },
+      [state, path, data, ok, ast] {
+        if (*ok)
+          state->resolve(ObjNew<ObjPrimitive>((i64)data->size()));
+        else
+          state->reject(std::make_exception_ptr(
+              Error(ast, "cannot write to file '" + path + "'")));
+      });
+
+  return ObjNew<ObjFuture>(TypeInfo(TypeKind::Future, {TypeKind::Int}), state);
+}
+
+// exec_async(command) -> future<string>
+//  run command by /bin/sh, result = stdout of it.
+define_builtin_func(ExecAsync) {
+  auto state = std::make_shared<io::FutureState>();
+
+  auto command = args[0]->ToString();
+
+  int fds[2];
+
+  if (pipe2(fds, O_CLOEXEC) != 0)
+    throw Error(ast, "cannot create pipe");
+
+  // only our side is non-blocking
+  fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+  posix_spawn_file_actions_t actions;
+
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+
+  char const* argv[] = {"sh", "-c", command.c_str(), nullptr};
+  pid_t pid;
+
+  int err = posix_spawn(&pid, "/bin/sh", &actions, nullptr, (char* const*)argv, environ);
+
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[1]);
+
+  if (err != 0) {
+    close(fds[0]);
+    throw Error(ast, "cannot run '" + command + "'");
+  }
+
+  auto output = std::make_shared<std::string>();
+
+  io::EventLoop::get().watch(fds[0], EPOLLIN, [fd = fds[0], pid, output, state] {
+    char buf[4096];
+    ssize_t n;
+
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+      output->append(buf, (size_t)n);
+
+    if (n < 0 && errno == EAGAIN)
+      return;
+
+    // closed by child
+    io::EventLoop::get().unwatch(fd);
+    close(fd);
+
+    waitpid(pid, nullptr, 0);
+
+    state->resolve(ObjNew<ObjString>(*output));
+  });
+
+  return ObjNew<ObjFuture>(TypeInfo(TypeKind::Future, {TypeKind::String}), state);
+}
+
 define_builtin_func(ToString) {
   return ObjNew<ObjString>(args[0]->ToString());
 }
@@ -116,6 +587,28 @@ static const std::vector<Function> g_builtin_functions = {
 
   { "open",     Open,      TypeKind::String, { TypeKind::String }, },
 
+  { "gc_collect", GC_Collect, TypeKind::Int, { }, },
+
+  // result type is thread<result of callable>
+  { "spawn", Spawn, TypeInfo(TypeKind::Thread, { TypeInfo::make_self_param(0) }),
+      { TypeKind::Unknown }, true },
+
+  { "make_channel", MakeChannel, TypeInfo(TypeKind::Channel, { TypeKind::Unknown }), { } },
+  { "make_channel", MakeChannel, TypeInfo(TypeKind::Channel, { TypeKind::Unknown }),
+      { TypeKind::Int } },
+
+  { "sleep_async", SleepAsync, TypeInfo(TypeKind::Future, { TypeKind::None }),
+      { TypeKind::Int } },
+
+  { "read_file_async", ReadFileAsync, TypeInfo(TypeKind::Future, { TypeKind::String }),
+      { TypeKind::String } },
+
+  { "write_file_async", WriteFileAsync, TypeInfo(TypeKind::Future, { TypeKind::Int }),
+      { TypeKind::String, TypeKind::String } },
+
+  { "exec_async", ExecAsync, TypeInfo(TypeKind::Future, { TypeKind::String }),
+      { TypeKind::String } },
+
 
 };
 
@@ -131,6 +624,53 @@ g_builtin_member_functions = {
 
   { TypeKind::String, { "length", Length, TypeKind::Int, { }, } },
   { TypeKind::Vector, { "length", Length, TypeKind::Int, { }, } },
+  { TypeKind::Dict,   { "length", Length, TypeKind::Int, { }, } },
+
+  //
+  // vector<T>
+  //
+  { TypeKind::Vector, { "sort", Vector_Sort, TypeKind::None, { } } },
+  { TypeKind::Vector, { "stable_sort", Vector_StableSort, TypeKind::None, { } } },
+  { TypeKind::Vector, { "partial_sort", Vector_PartialSort, TypeKind::None, { TypeKind::Int } } },
+
+  { TypeKind::Vector, { "sort_by", Vector_SortBy, TypeKind::None,
+      { TypeInfo(TypeKind::Function, { TypeKind::Bool, TypeInfo::make_self_param(0),
+                                       TypeInfo::make_self_param(0) }) } } },
+
+  { TypeKind::Vector, { "to_columns", Vector_ToColumns, TypeKind::None, { } } },
+  { TypeKind::Vector, { "to_rows", Vector_ToRows, TypeKind::None, { } } },
+
+  //
+  // thread<T>
+  //
+  { TypeKind::Thread, { "join", Thread_Join, TypeInfo::make_self_param(0), { } } },
+
+  //
+  // channel<T>
+  //
+  { TypeKind::Channel, { "send", Channel_Send, TypeKind::None,
+      { TypeInfo::make_self_param(0) } } },
+
+  { TypeKind::Channel, { "recv", Channel_Recv, TypeInfo::make_self_param(0), { } } },
+  { TypeKind::Channel, { "close", Channel_Close, TypeKind::None, { } } },
+
+  //
+  // dict<K, V>
+  //
+  { TypeKind::Dict, { "get", Dict_Get, TypeInfo::make_self_param(1),
+      { TypeInfo::make_self_param(0), TypeInfo::make_self_param(1) } } },
+
+  { TypeKind::Dict, { "insert", Dict_Insert, TypeKind::None,
+      { TypeInfo::make_self_param(0), TypeInfo::make_self_param(1) } } },
+
+  { TypeKind::Dict, { "remove", Dict_Remove, TypeKind::Bool,
+      { TypeInfo::make_self_param(0) } } },
+
+  { TypeKind::Dict, { "contains", Dict_Contains, TypeKind::Bool,
+      { TypeInfo::make_self_param(0) } } },
+
+  { TypeKind::Dict, { "keys", Dict_Keys,
+      TypeInfo(TypeKind::Vector, { TypeInfo::make_self_param(0) }), { } } },
   
   { TypeKind::Unknown, { "to_string", ToString, TypeKind::String, { }, } },
   
@@ -166,14 +706,25 @@ ObjPointer Function::Call(ASTPtr<AST::CallFunc> ast, ObjVector args) const {
 }
 
 Function const* find_builtin_func(std::string const& name) {
-  auto const& funcs = get_builtin_functions();
+  auto funcs = find_builtin_funcs(name);
 
-  for (auto&& f : funcs) {
-    if (f.name == name)
-      return &f;
-  }
+  return funcs ? (*funcs)[0] : nullptr;
+}
+
+vector<Function const*> const* find_builtin_funcs(string_view name) {
+  using Table = HashMap<string_view, vector<Function const*>, std::hash<string_view>,
+                        std::equal_to<string_view>>;
+
+  static Table const table = [] {
+    Table t;
+
+    for (auto&& f : g_builtin_functions)
+      t[f.name].emplace_back(&f);
+
+    return t;
+  }();
 
-  return nullptr;
+  return table.find(name);
 }
 
 vector<builtins::Function> const& get_builtin_functions() {
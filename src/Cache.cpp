@@ -0,0 +1,1283 @@
+#include <cstring>
+#include <typeinfo>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "alert.h"
+#include "AST.h"
+#include "Builtin.h"
+#include "Object.h"
+#include "Source.h"
+#include "Cache.h"
+
+namespace fire {
+
+//
+// layout of cache file
+//
+//   CacheHeader
+//   tokens of source
+//   count of nodes, and (type, kind) of each node
+//   fields of each node
+//   index of root
+//
+//  links between nodes are saved as index + 1 of node in arena. (0 = null)
+//  strings are saved as offset in source if they are in it.
+//
+
+// changed when layout of file or fields of AST are changed.
+static constexpr u32 FormatVersion = 2;
+
+static constexpr char Magic[8] = {'F', 'I', 'R', 'E', 'C', 0, 0, 0};
+
+struct CacheHeader {
+  char magic[8];
+  u32 format;
+  u32 _reserved;
+  u64 key[2];
+  u64 source_size;
+  u64 payload_size;
+  u64 payload_hash;
+};
+
+//
+// 128-bit hash of bytes. (two lanes, 8 bytes at once)
+//
+static inline u64 fold_mul(u64 x, u64 k) {
+  auto r = static_cast<unsigned __int128>(x) * k;
+  return static_cast<u64>(r) ^ static_cast<u64>(r >> 64);
+}
+
+static void hash_bytes(u64 out[2], char const* p, size_t n, u64 seed) {
+  constexpr u64 K0 = 0x9E3779B97F4A7C15ull;
+  constexpr u64 K1 = 0xC2B2AE3D27D4EB4Full;
+
+  u64 a = seed ^ n ^ 0x243F6A8885A308D3ull;
+  u64 b = seed ^ (n * K0) ^ 0x13198A2E03707344ull;
+
+  for (; n >= 8; p += 8, n -= 8) {
+    u64 w;
+    std::memcpy(&w, p, 8);
+
+    a = fold_mul(a ^ w, K0);
+    b = fold_mul(b ^ w, K1);
+  }
+
+  if (n) {
+    u64 w = 0;
+    std::memcpy(&w, p, n);
+
+    a = fold_mul(a ^ w, K0);
+    b = fold_mul(b ^ w, K1);
+  }
+
+  out[0] = fold_mul(a ^ (b >> 29), K1);
+  out[1] = fold_mul(b ^ (a >> 31), K0);
+}
+
+// thrown when AST has something which cannot be saved, or file is broken.
+struct CacheError {};
+
+//
+// types of nodes. (dynamic type, kind may be changed by Sema)
+//
+#define FIRE_CACHE_NODE_TYPES(X)                                                   \
+  X(Value)                                                                         \
+  X(Identifier)                                                                    \
+  X(ScopeResol)                                                                    \
+  X(Array)                                                                         \
+  X(Tuple)                                                                         \
+  X(Dict)                                                                          \
+  X(CallFunc)                                                                      \
+  X(Expr)                                                                          \
+  X(Block)                                                                         \
+  X(VarDef)                                                                        \
+  X(Statement)                                                                     \
+  X(Match)                                                                         \
+  X(Argument)                                                                      \
+  X(Function)                                                                      \
+  X(TypeName)                                                                      \
+  X(Signature)                                                                     \
+  X(Enum)                                                                          \
+  X(Class)
+
+enum class NodeType : u8 {
+#define X(T) T,
+  FIRE_CACHE_NODE_TYPES(X)
+#undef X
+      _Count,
+};
+
+template <class T>
+struct NodeTypeOf;
+
+#define X(T)                                                                       \
+  template <>                                                                      \
+  struct NodeTypeOf<AST::T> {                                                      \
+    static constexpr NodeType value = NodeType::T;                                 \
+  };
+FIRE_CACHE_NODE_TYPES(X)
+#undef X
+
+static NodeType get_node_type(AST::Base const* ast) {
+  auto const& type = typeid(*ast);
+
+#define X(T)                                                                       \
+  if (type == typeid(AST::T))                                                      \
+    return NodeType::T;
+  FIRE_CACHE_NODE_TYPES(X)
+#undef X
+
+  throw CacheError{};
+}
+
+// element of vector which is read from file
+template <class T>
+static T blank() {
+  return T();
+}
+
+template <>
+AST::Match::Pattern blank() {
+  return {AST::Match::Pattern::Type::Unknown, nullptr, nullptr};
+}
+
+template <class Ar>
+static void serialize(Ar& ar, Token& tok);
+
+template <class Ar>
+static void serialize(Ar& ar, TypeInfo& type);
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Match::Pattern& P);
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Statement::Switch::Case& C);
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Statement::TryCatch::Catcher& C);
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Enum::Enumerator& E);
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Class::Field& F);
+
+//
+// Writer
+//
+class Writer {
+  SourceStorage const& source;
+
+public:
+  std::string buf;
+
+  // node => index + 1
+  std::unordered_map<AST::Base const*, u32> index;
+
+  explicit Writer(SourceStorage const& source)
+      : source(source) {
+  }
+
+  void put(void const* p, size_t n) {
+    this->buf.append((char const*)p, n);
+  }
+
+  template <class T>
+  void put(T x) {
+    this->put(&x, sizeof(T));
+  }
+
+  template <class T>
+  requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+  void operator()(T& x) {
+    this->put(&x, sizeof(T));
+  }
+
+  template <class T>
+  requires std::is_class_v<T>
+  void operator()(T& x) {
+    serialize(*this, x);
+  }
+
+  void operator()(string_view& s) {
+    auto const src = this->source.data;
+
+    if (s.data() >= src.data() && s.data() + s.length() <= src.data() + src.length()) {
+      this->put<u8>(0);
+      this->put((u32)(s.data() - src.data()));
+      this->put((u32)s.length());
+    }
+    else {
+      this->put<u8>(1);
+      this->put((u32)s.length());
+      this->put(s.data(), s.length());
+    }
+  }
+
+  void operator()(std::string& s) {
+    this->put((u32)s.length());
+    this->put(s.data(), s.length());
+  }
+
+  void operator()(TypeId& type) {
+    auto t = type.get();
+    serialize(*this, t);
+  }
+
+  // flags: 1 = has location in source,
+  //        2 = str is same as the location (not saved)
+  void token_text(Token& tok) {
+    auto const& loc = tok.sourceloc;
+    auto const src = this->source.data;
+
+    if (loc.ref && loc.ref != &this->source)
+      throw CacheError{};
+
+    bool same = loc.ref && loc.position <= src.length() &&
+                tok.str.data() == src.data() + loc.position &&
+                tok.str.length() == loc.length;
+
+    this->put<u8>((loc.ref ? 1 : 0) | (same ? 2 : 0));
+
+    if (!same)
+      (*this)(tok.str);
+  }
+
+  template <class T>
+  requires std::derived_from<T, AST::Base>
+  void operator()(T*& ast) {
+    if (!ast) {
+      this->put<u32>(0);
+      return;
+    }
+
+    auto it = this->index.find(ast);
+
+    // not in arena
+    if (it == this->index.end())
+      throw CacheError{};
+
+    this->put(it->second);
+  }
+
+  void operator()(builtins::Function const*& func) {
+    if (!func) {
+      this->put<u8>(0);
+      return;
+    }
+
+    auto const& funcs = builtins::get_builtin_functions();
+
+    if (func >= funcs.data() && func < funcs.data() + funcs.size()) {
+      this->put<u8>(1);
+      this->put((u32)(func - funcs.data()));
+      return;
+    }
+
+    auto const& members = builtins::get_builtin_member_functions();
+
+    for (u32 i = 0; i < members.size(); i++) {
+      if (func == &members[i].second) {
+        this->put<u8>(2);
+        this->put(i);
+        return;
+      }
+    }
+
+    throw CacheError{};
+  }
+
+  void operator()(builtins::MemberVariable const*& var) {
+    auto const& vars = builtins::get_builtin_member_variables();
+
+    if (!var) {
+      this->put<u32>(0);
+      return;
+    }
+
+    if (var < vars.data() || var >= vars.data() + vars.size())
+      throw CacheError{};
+
+    this->put((u32)(var - vars.data() + 1));
+  }
+
+  // constants in AST are primitive or string.
+  void operator()(ObjPointer& obj) {
+    if (!obj) {
+      this->put<u8>(0);
+      return;
+    }
+
+    switch (obj->type.kind) {
+    case TypeKind::Int:
+    case TypeKind::Float:
+    case TypeKind::Bool:
+    case TypeKind::Char:
+      this->put<u8>(1);
+      this->put(obj->type.kind);
+      this->put(obj->As<ObjPrimitive>()->_data);
+      return;
+
+    case TypeKind::String: {
+      auto str = obj->As<ObjString>();
+
+      this->put<u8>(2);
+      this->put((u32)str->list.size());
+
+      for (auto&& c : str->list)
+        this->put(c->As<ObjPrimitive>()->vc);
+
+      return;
+    }
+    }
+
+    throw CacheError{};
+  }
+
+  template <class T>
+  void operator()(vector<T>& v) {
+    this->put((u32)v.size());
+
+    for (auto&& x : v)
+      (*this)(x);
+  }
+
+  template <class A, class B>
+  void operator()(std::pair<A, B>& p) {
+    (*this)(p.first);
+    (*this)(p.second);
+  }
+
+  // keys are values of patterns, so only indices of patterns are saved.
+  void match_hash(AST::Match& x) {
+    this->put((u32)x.hash.size());
+
+    for (auto&& [key, i] : x.hash)
+      this->put(i);
+  }
+};
+
+//
+// Reader
+//
+class Reader {
+  SourceStorage& source;
+
+  char const* p;
+  char const* end;
+
+public:
+  vector<AST::Base*> nodes;
+  vector<NodeType> types;
+
+  Reader(SourceStorage& source, char const* p, char const* end)
+      : source(source),
+        p(p),
+        end(end) {
+  }
+
+  bool is_end() const {
+    return this->p == this->end;
+  }
+
+  size_t remain() const {
+    return (size_t)(this->end - this->p);
+  }
+
+  char const* take(size_t n) {
+    if (this->remain() < n)
+      throw CacheError{};
+
+    auto s = this->p;
+
+    this->p += n;
+
+    return s;
+  }
+
+  template <class T>
+  T get() {
+    T x;
+    std::memcpy(&x, this->take(sizeof(T)), sizeof(T));
+    return x;
+  }
+
+  template <class T>
+  requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+  void operator()(T& x) {
+    x = this->get<T>();
+  }
+
+  template <class T>
+  requires std::is_class_v<T>
+  void operator()(T& x) {
+    serialize(*this, x);
+  }
+
+  void operator()(string_view& s) {
+    auto in_source = this->get<u8>() == 0;
+
+    if (in_source) {
+      auto pos = this->get<u32>();
+      auto len = this->get<u32>();
+
+      if ((size_t)pos + len > this->source.data.length())
+        throw CacheError{};
+
+      s = this->source.data.substr(pos, len);
+    }
+    else {
+      auto len = this->get<u32>();
+
+      s = string_view(this->take(len), len);
+    }
+  }
+
+  void operator()(std::string& s) {
+    auto len = this->get<u32>();
+
+    s.assign(this->take(len), len);
+  }
+
+  void operator()(TypeId& type) {
+    TypeInfo t;
+    serialize(*this, t);
+    type = TypeId(t);
+  }
+
+  void token_text(Token& tok) {
+    auto& loc = tok.sourceloc;
+    auto flags = this->get<u8>();
+
+    loc.ref = (flags & 1) ? &this->source : nullptr;
+
+    if (flags & 2) {
+      if ((size_t)loc.position + loc.length > this->source.data.length())
+        throw CacheError{};
+
+      tok.str = this->source.data.substr(loc.position, loc.length);
+    }
+    else {
+      (*this)(tok.str);
+    }
+  }
+
+  template <class T>
+  requires std::derived_from<T, AST::Base>
+  void operator()(T*& ast) {
+    auto i = this->get<u32>();
+
+    if (i == 0) {
+      ast = nullptr;
+      return;
+    }
+
+    if (--i >= this->nodes.size())
+      throw CacheError{};
+
+    if constexpr (!std::is_same_v<T, AST::Base>)
+      if (this->types[i] != NodeTypeOf<T>::value)
+        throw CacheError{};
+
+    ast = static_cast<T*>(this->nodes[i]);
+  }
+
+  void operator()(builtins::Function const*& func) {
+    auto tag = this->get<u8>();
+
+    if (tag == 0) {
+      func = nullptr;
+      return;
+    }
+
+    auto i = this->get<u32>();
+
+    if (tag == 1 && i < builtins::get_builtin_functions().size())
+      func = &builtins::get_builtin_functions()[i];
+    else if (tag == 2 && i < builtins::get_builtin_member_functions().size())
+      func = &builtins::get_builtin_member_functions()[i].second;
+    else
+      throw CacheError{};
+  }
+
+  void operator()(builtins::MemberVariable const*& var) {
+    auto i = this->get<u32>();
+
+    if (i > builtins::get_builtin_member_variables().size())
+      throw CacheError{};
+
+    var = i ? &builtins::get_builtin_member_variables()[i - 1] : nullptr;
+  }
+
+  void operator()(ObjPointer& obj) {
+    switch (this->get<u8>()) {
+    case 0:
+      obj = nullptr;
+      return;
+
+    case 1: {
+      auto kind = this->get<TypeKind>();
+
+      if (kind != TypeKind::Int && kind != TypeKind::Float && kind != TypeKind::Bool &&
+          kind != TypeKind::Char)
+        throw CacheError{};
+
+      auto prim = ObjNew<ObjPrimitive>();
+
+      prim->type = kind;
+      prim->_data = this->get<u64>();
+
+      obj = prim;
+      return;
+    }
+
+    case 2: {
+      auto len = this->get<u32>();
+      auto s = this->take((size_t)len * sizeof(char16_t));
+
+      std::u16string str(len, 0);
+      std::memcpy(str.data(), s, (size_t)len * sizeof(char16_t));
+
+      obj = ObjNew<ObjString>(str);
+      return;
+    }
+    }
+
+    throw CacheError{};
+  }
+
+  template <class T>
+  void operator()(vector<T>& v) {
+    auto n = this->get<u32>();
+
+    // every element has one byte at least
+    if (n > this->remain())
+      throw CacheError{};
+
+    v.clear();
+    v.reserve(n);
+
+    for (u32 i = 0; i < n; i++)
+      (*this)(v.emplace_back(blank<T>()));
+  }
+
+  template <class A, class B>
+  void operator()(std::pair<A, B>& p) {
+    (*this)(p.first);
+    (*this)(p.second);
+  }
+
+  // values of patterns may be read after the match, so hash tables are
+  // made after all nodes are read. (see finish)
+  void match_hash(AST::Match& x) {
+    (*this)(this->hashes.emplace_back(&x, vector<u32>()).second);
+  }
+
+  void finish() {
+    for (auto&& [x, indices] : this->hashes) {
+      x->hash.clear();
+
+      for (auto i : indices) {
+        if (i >= x->patterns.size() || !x->patterns[i].expr ||
+            x->patterns[i].expr->kind != ASTKind::Value ||
+            !x->patterns[i].expr->as_value()->value)
+          throw CacheError{};
+
+        x->hash.try_emplace(x->patterns[i].expr->as_value()->value, i);
+      }
+    }
+  }
+
+private:
+  vector<std::pair<AST::Match*, vector<u32>>> hashes;
+};
+
+// ----------------------------------- //
+//  fields
+
+template <class Ar>
+static void serialize(Ar& ar, Token& tok) {
+  ar(tok.kind);
+  ar(tok.keyword);
+  ar(tok._index);
+  ar(tok.sourceloc.position);
+  ar(tok.sourceloc.length);
+  ar.token_text(tok);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, TypeInfo& type) {
+  ar(type.kind);
+  ar(type.params);
+  ar(type.name);
+  ar(type.is_const);
+  ar(type.type_ast);
+  ar(type.enum_index);
+  ar(type.is_free_args);
+  ar(type.is_member_func);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Match::Pattern& P) {
+  ar(P.type);
+  ar(P.expr);
+  ar(P.block);
+  ar(P.everything);
+  ar(P.is_eval_expr);
+  ar(P.vardef_list);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Statement::Switch::Case& C) {
+  ar(C.expr);
+  ar(C.block);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Statement::TryCatch::Catcher& C) {
+  ar(C.varname);
+  ar(C.type);
+  ar(C.catched);
+  ar(C._type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Enum::Enumerator& E) {
+  ar(E.name);
+  ar(E.data_type);
+  ar(E.types);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Class::Field& F) {
+  ar(F.kind);
+  ar(F.offset);
+}
+
+// ----------------------------------- //
+//  nodes
+
+template <class Ar>
+static void serialize_base(Ar& ar, AST::Base& x) {
+  ar(x.kind);
+  ar(x.token);
+  ar(x.endtok);
+  ar(x.is_named);
+  ar(x.is_expr);
+  ar(x._constructed_as);
+}
+
+template <class Ar>
+static void serialize_named(Ar& ar, AST::Named& x) {
+  serialize_base(ar, x);
+  ar(x.name);
+}
+
+template <class Ar>
+static void serialize_templatable(Ar& ar, AST::Templatable& x) {
+  serialize_named(ar, x);
+  ar(x.tok_template);
+  ar(x.is_templated);
+  ar(x.template_param_names);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Value& x) {
+  serialize_base(ar, x);
+  ar(x.value);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Identifier& x) {
+  serialize_named(ar, x);
+  ar(x.paramtok);
+  ar(x.id_params);
+  ar(x.sema_must_completed);
+  ar(x.sema_allow_ambiguous);
+  ar(x.sema_use_keeped);
+  ar(x.candidates);
+  ar(x.candidates_builtin);
+  ar(x.ft_ret);
+  ar(x.ft_args);
+  ar(x.template_args);
+  ar(x.blt_member_var);
+  ar(x.distance);
+  ar(x.index);
+  ar(x.index_add);
+  ar(x.ast_class);
+  ar(x.ast_enum);
+  ar(x.self_type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::ScopeResol& x) {
+  serialize_named(ar, x);
+  ar(x.first);
+  ar(x.idlist);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Array& x) {
+  serialize_base(ar, x);
+  ar(x.elements);
+  ar(x.elem_type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Tuple& x) {
+  serialize_base(ar, x);
+  ar(x.elements);
+  ar(x.type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Dict& x) {
+  serialize_base(ar, x);
+  ar(x.elements);
+  ar(x.type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::CallFunc& x) {
+  serialize_base(ar, x);
+  ar(x.callee);
+  ar(x.args);
+  ar(x.callee_ast);
+  ar(x.callee_builtin);
+  ar(x.call_functor);
+  ar(x.ast_enum);
+  ar(x.enum_index);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Expr& x) {
+  serialize_base(ar, x);
+  ar(x.op);
+  ar(x.lhs);
+  ar(x.rhs);
+  ar(x.is_concat);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Block& x) {
+  serialize_base(ar, x);
+  ar(x.list);
+  ar(x.stack_size);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::VarDef& x) {
+  serialize_named(ar, x);
+  ar(x.type);
+  ar(x.init);
+  ar(x.unpack);
+  ar(x.index);
+  ar(x.index_add);
+}
+
+static bool has_statement_data(ASTKind kind) {
+  switch (kind) {
+  case ASTKind::If:
+  case ASTKind::Switch:
+  case ASTKind::While:
+  case ASTKind::ForEach:
+  case ASTKind::ParallelFor:
+  case ASTKind::TryCatch:
+    return true;
+  }
+
+  return false;
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Statement& x) {
+  // data is made for this kind. (see new_node)
+  auto kind = x.kind;
+
+  serialize_base(ar, x);
+
+  if (x.kind != kind || (has_statement_data(kind) && !x._data))
+    throw CacheError{};
+
+  switch (kind) {
+  case ASTKind::If:
+    ar(x.data_if->cond);
+    ar(x.data_if->if_true);
+    ar(x.data_if->if_false);
+    break;
+
+  case ASTKind::Switch:
+    ar(x.data_switch->cond);
+    ar(x.data_switch->cases);
+    break;
+
+  case ASTKind::While:
+    ar(x.data_while->cond);
+    ar(x.data_while->block);
+    break;
+
+  case ASTKind::ForEach:
+    ar(x.data_for_each->varname);
+    ar(x.data_for_each->iterable);
+    ar(x.data_for_each->block);
+    ar(x.data_for_each->_elem_type);
+    break;
+
+  case ASTKind::ParallelFor: {
+    auto d = x.data_parallel_for;
+
+    ar(d->varname);
+    ar(d->begin);
+    ar(d->end);
+    ar(d->block);
+    ar(d->op);
+    ar(d->acc);
+    ar(d->_acc_type);
+    break;
+  }
+
+  case ASTKind::TryCatch:
+    ar(x.data_try_catch->tryblock);
+    ar(x.data_try_catch->catchers);
+    break;
+  }
+
+  ar(x.expr);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Match& x) {
+  serialize_base(ar, x);
+  ar(x.cond);
+  ar(x.patterns);
+  ar(x.dispatch);
+  ar(x.table_base);
+  ar(x.table);
+  ar(x.enum_table);
+  ar.match_hash(x);
+  ar(x.fallback);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Argument& x) {
+  serialize_named(ar, x);
+  ar(x.type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Function& x) {
+  serialize_templatable(ar, x);
+  ar(x.arguments);
+  ar(x.return_type);
+  ar(x.block);
+  ar(x.is_var_arg);
+  ar(x.is_async);
+  ar(x.is_generator);
+  ar(x.member_of);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::TypeName& x) {
+  serialize_named(ar, x);
+  ar(x.sig);
+  ar(x.type_params);
+  ar(x.is_const);
+  ar(x.type);
+  ar(x.ast_class);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Signature& x) {
+  serialize_base(ar, x);
+  ar(x.arg_type_list);
+  ar(x.result_type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Enum& x) {
+  serialize_templatable(ar, x);
+  ar(x.enumerators);
+  ar(x.enumerator_type);
+}
+
+template <class Ar>
+static void serialize(Ar& ar, AST::Class& x) {
+  serialize_templatable(ar, x);
+  ar(x.member_variables);
+  ar(x.member_functions);
+  ar(x.layout);
+  ar(x.fields_size);
+  ar(x.instance_type);
+}
+
+template <class Ar>
+static void serialize_node(Ar& ar, NodeType type, AST::Base* ast) {
+  switch (type) {
+#define X(T)                                                                       \
+  case NodeType::T:                                                                \
+    serialize(ar, *ast->As<AST::T>());                                                    \
+    break;
+    FIRE_CACHE_NODE_TYPES(X)
+#undef X
+
+  default:
+    throw CacheError{};
+  }
+}
+
+//
+// makes empty node in current arena. fields are read after all nodes are made.
+//
+static AST::Base* new_node(NodeType type, ASTKind kind) {
+  auto& arena = AST::Arena::current();
+
+  // constructors of CallFunc and ScopeResol take token from this
+  static AST::Identifier dummy{Token()};
+
+  switch (type) {
+  case NodeType::Value:
+    return arena.New<AST::Value>(Token(), nullptr);
+
+  case NodeType::Identifier:
+    return arena.New<AST::Identifier>(Token());
+
+  case NodeType::ScopeResol:
+    return arena.New<AST::ScopeResol>(&dummy);
+
+  case NodeType::Array:
+    return arena.New<AST::Array>(Token());
+
+  case NodeType::Tuple:
+    return arena.New<AST::Tuple>(Token());
+
+  case NodeType::Dict:
+    return arena.New<AST::Dict>(Token());
+
+  case NodeType::CallFunc:
+    return arena.New<AST::CallFunc>(&dummy);
+
+  case NodeType::Expr:
+    return arena.New<AST::Expr>(kind, Token(), nullptr, nullptr);
+
+  case NodeType::Block:
+    return arena.New<AST::Block>(Token());
+
+  case NodeType::VarDef:
+    return arena.New<AST::VarDef>(Token(), Token());
+
+  case NodeType::Statement: {
+    void* data = nullptr;
+
+    switch (kind) {
+    case ASTKind::If:
+      data = new AST::Statement::If{};
+      break;
+
+    case ASTKind::Switch:
+      data = new AST::Statement::Switch{};
+      break;
+
+    case ASTKind::While:
+      data = new AST::Statement::While{};
+      break;
+
+    case ASTKind::ForEach:
+      data = new AST::Statement::ForEach{};
+      break;
+
+    case ASTKind::ParallelFor:
+      data = new AST::Statement::ParallelFor{};
+      break;
+
+    case ASTKind::TryCatch:
+      data = new AST::Statement::TryCatch{};
+      break;
+    }
+
+    return arena.New<AST::Statement>(kind, Token(), data);
+  }
+
+  case NodeType::Match:
+    return arena.New<AST::Match>(Token(), nullptr, Vec<AST::Match::Pattern>{});
+
+  case NodeType::Argument:
+    return arena.New<AST::Argument>(Token(), nullptr);
+
+  case NodeType::Function:
+    return arena.New<AST::Function>(Token(), Token());
+
+  case NodeType::TypeName:
+    return arena.New<AST::TypeName>(Token());
+
+  case NodeType::Signature:
+    return arena.New<AST::Signature>(Token(), ASTVec<AST::TypeName>{}, nullptr);
+
+  case NodeType::Enum:
+    return arena.New<AST::Enum>(Token(), Token());
+
+  case NodeType::Class:
+    return arena.New<AST::Class>(Token(), Token());
+  }
+
+  throw CacheError{};
+}
+
+// ----------------------------------- //
+
+//
+// directory of cache files. (empty if unknown)
+//
+static std::string get_cache_dir() {
+  std::string dir;
+
+  if (auto xdg = getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+    dir = xdg;
+  }
+  else if (auto home = getenv("HOME"); home && *home) {
+    dir = std::string(home) + "/.cache";
+  }
+  else {
+    return "";
+  }
+
+  mkdir(dir.c_str(), 0755);
+
+  dir += "/fire";
+  mkdir(dir.c_str(), 0755);
+
+  return dir;
+}
+
+ProgramCache::ProgramCache(SourceStorage& source)
+    : source(source) {
+}
+
+ProgramCache::~ProgramCache() {
+  if (this->mapped)
+    munmap(this->mapped, this->mapped_size);
+}
+
+//
+// GetPath
+//
+//  key is hash of source, seeded by version, format of file, and size and
+//  time of executable. (rebuilt interpreter may have other layout of AST)
+//
+std::string const& ProgramCache::GetPath() {
+  if (!this->path.empty())
+    return this->path;
+
+  auto dir = get_cache_dir();
+
+  if (dir.empty())
+    return this->path;
+
+  struct stat st = {};
+
+  stat("/proc/self/exe", &st);
+
+  auto ident = std::string("fire " FIRE_VERSION);
+  u64 exe[] = {(u64)st.st_size, (u64)st.st_mtim.tv_sec, (u64)st.st_mtim.tv_nsec,
+               (u64)st.st_ino};
+
+  ident.append((char const*)exe, sizeof(exe));
+
+  u64 seed[2];
+
+  hash_bytes(seed, ident.data(), ident.length(), FormatVersion);
+  hash_bytes(this->key, this->source.data.data(), this->source.data.length(),
+             seed[0] ^ seed[1]);
+
+  char name[40];
+
+  snprintf(name, sizeof(name), "%016llx%016llx", (unsigned long long)this->key[0],
+           (unsigned long long)this->key[1]);
+
+  return this->path = dir + "/" + name + ".firec";
+}
+
+ASTPtr<AST::Block> ProgramCache::Load() {
+  auto const& path = this->GetPath();
+
+  if (path.empty())
+    return nullptr;
+
+  int fd = open(path.c_str(), O_RDONLY);
+
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(CacheHeader)) {
+    close(fd);
+    return nullptr;
+  }
+
+  auto size = (size_t)st.st_size;
+  auto p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (p == MAP_FAILED)
+    return nullptr;
+
+  auto const begin = (char const*)p + sizeof(CacheHeader);
+  auto const end = (char const*)p + size;
+
+  CacheHeader header;
+  std::memcpy(&header, p, sizeof(CacheHeader));
+
+  u64 hash[2];
+  bool ok = std::memcmp(header.magic, Magic, sizeof(Magic)) == 0 &&
+            header.format == FormatVersion && header.key[0] == this->key[0] &&
+            header.key[1] == this->key[1] &&
+            header.source_size == this->source.data.length() &&
+            header.payload_size == (u64)(end - begin);
+
+  if (ok) {
+    hash_bytes(hash, begin, end - begin, 0);
+    ok = header.payload_hash == hash[0];
+  }
+
+  if (!ok) {
+    munmap(p, size);
+    return nullptr;
+  }
+
+  this->mapped = p;
+  this->mapped_size = size;
+
+  Reader reader{this->source, begin, end};
+
+  try {
+    reader(this->source.token_list);
+
+    auto count = reader.get<u32>();
+
+    if ((size_t)count * 2 > reader.remain())
+      throw CacheError{};
+
+    reader.nodes.reserve(count);
+    reader.types.reserve(count);
+
+    for (u32 i = 0; i < count; i++) {
+      auto type = reader.get<NodeType>();
+      auto kind = reader.get<u8>();
+
+      if (type >= NodeType::_Count || kind > (u8)ASTKind::Signature)
+        throw CacheError{};
+
+      reader.types.emplace_back(type);
+      reader.nodes.emplace_back(new_node(type, (ASTKind)kind));
+    }
+
+    for (u32 i = 0; i < count; i++)
+      serialize_node(reader, reader.types[i], reader.nodes[i]);
+
+    reader.finish();
+
+    ASTPtr<AST::Block> root;
+
+    reader(root);
+
+    if (!root || !reader.is_end())
+      throw CacheError{};
+
+    return root;
+  }
+  catch (CacheError) {
+    // nodes already made are left in arena.
+    this->source.token_list.clear();
+  }
+
+  return nullptr;
+}
+
+bool ProgramCache::Save(ASTPtr<AST::Block> root) {
+  auto const& path = this->GetPath();
+
+  if (path.empty())
+    return false;
+
+  auto const& nodes = AST::Arena::current().get_nodes();
+
+  Writer writer{this->source};
+
+  try {
+    vector<NodeType> types;
+
+    types.reserve(nodes.size());
+    writer.index.reserve(nodes.size());
+
+    for (u32 i = 0; i < nodes.size(); i++) {
+      types.emplace_back(get_node_type(nodes[i]));
+      writer.index.emplace(nodes[i], i + 1);
+    }
+
+    writer(this->source.token_list);
+
+    writer.put((u32)nodes.size());
+
+    for (u32 i = 0; i < nodes.size(); i++) {
+      writer.put(types[i]);
+      writer.put((u8)nodes[i]->kind);
+    }
+
+    for (u32 i = 0; i < nodes.size(); i++)
+      serialize_node(writer, types[i], nodes[i]);
+
+    writer(root);
+  }
+  catch (CacheError) {
+    return false;
+  }
+
+  auto const& payload = writer.buf;
+
+  CacheHeader header = {};
+  u64 hash[2];
+
+  hash_bytes(hash, payload.data(), payload.size(), 0);
+
+  std::memcpy(header.magic, Magic, sizeof(Magic));
+  header.format = FormatVersion;
+  header.key[0] = this->key[0];
+  header.key[1] = this->key[1];
+  header.source_size = this->source.data.length();
+  header.payload_size = payload.size();
+  header.payload_hash = hash[0];
+
+  // written to other file, and renamed. (other process may read it)
+  auto temp = path + "." + std::to_string(getpid()) + ".tmp";
+
+  int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0)
+    return false;
+
+  bool ok = write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header);
+
+  for (size_t done = 0; ok && done < payload.size();) {
+    auto n = write(fd, payload.data() + done, payload.size() - done);
+
+    if (n <= 0)
+      ok = false;
+    else
+      done += (size_t)n;
+  }
+
+  if (close(fd) < 0 || !ok || rename(temp.c_str(), path.c_str()) < 0) {
+    unlink(temp.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace fire
@@ -0,0 +1,220 @@
+#include <bit>
+
+#include "Channel.h"
+#include "Object.h"
+#include "GC.h"
+#include "Error.h"
+
+namespace fire {
+
+Channel::Channel(size_t capacity) {
+  if (capacity == 0)
+    return;
+
+  capacity = std::bit_ceil(capacity);
+
+  this->cells = new Cell[capacity];
+  this->mask = capacity - 1;
+
+  for (size_t i = 0; i < capacity; i++)
+    this->cells[i].seq.store(i, std::memory_order_relaxed);
+}
+
+Channel::~Channel() {
+  delete[] this->cells;
+}
+
+bool Channel::try_push(ObjPointer& obj) {
+  if (!this->cells) {
+    std::lock_guard lock(this->mtx);
+
+    this->queue.emplace_back(std::move(obj));
+
+    return true;
+  }
+
+  Cell* cell;
+  auto pos = this->enqueue_pos.load(std::memory_order_relaxed);
+
+  while (true) {
+    cell = &this->cells[pos & this->mask];
+
+    auto seq = cell->seq.load(std::memory_order_acquire);
+    auto diff = (intptr_t)seq - (intptr_t)pos;
+
+    if (diff == 0) {
+      if (this->enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false; // full
+    else
+      pos = this->enqueue_pos.load(std::memory_order_relaxed);
+  }
+
+  cell->value = std::move(obj);
+  cell->seq.store(pos + 1, std::memory_order_release);
+
+  return true;
+}
+
+bool Channel::try_pop(ObjPointer& out) {
+  if (!this->cells) {
+    std::lock_guard lock(this->mtx);
+
+    if (this->queue.empty())
+      return false;
+
+    out = std::move(this->queue.front());
+    this->queue.pop_front();
+
+    return true;
+  }
+
+  Cell* cell;
+  auto pos = this->dequeue_pos.load(std::memory_order_relaxed);
+
+  while (true) {
+    cell = &this->cells[pos & this->mask];
+
+    auto seq = cell->seq.load(std::memory_order_acquire);
+    auto diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+    if (diff == 0) {
+      if (this->dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false; // empty
+    else
+      pos = this->dequeue_pos.load(std::memory_order_relaxed);
+  }
+
+  out = std::move(cell->value);
+  cell->seq.store(pos + this->mask + 1, std::memory_order_release);
+
+  return true;
+}
+
+bool Channel::Send(ObjPointer& obj) {
+  while (true) {
+    if (this->is_closed())
+      return false;
+
+    // counter is read before trying, so a pop between try and wait is not missed.
+    auto popped = this->popped.load(std::memory_order_acquire);
+
+    if (this->try_push(obj)) {
+      this->pushed.fetch_add(1, std::memory_order_release);
+      this->pushed.notify_all();
+      return true;
+    }
+
+    this->popped.wait(popped, std::memory_order_acquire);
+  }
+}
+
+ObjPointer Channel::Recv() {
+  ObjPointer obj = nullptr;
+
+  while (true) {
+    auto pushed = this->pushed.load(std::memory_order_acquire);
+
+    if (this->try_pop(obj)) {
+      this->popped.fetch_add(1, std::memory_order_release);
+      this->popped.notify_all();
+      return obj;
+    }
+
+    // objects sent before close are received.
+    if (this->is_closed())
+      return this->try_pop(obj) ? obj : nullptr;
+
+    this->pushed.wait(pushed, std::memory_order_acquire);
+  }
+}
+
+void Channel::Close() {
+  this->closed.store(true, std::memory_order_release);
+
+  // wake up all waiting threads
+  this->pushed.fetch_add(1, std::memory_order_release);
+  this->popped.fetch_add(1, std::memory_order_release);
+
+  this->pushed.notify_all();
+  this->popped.notify_all();
+}
+
+// true if obj and all objects reachable from it are referenced only once.
+// (then they can be moved to other thread without copy)
+static bool is_unique(Object* obj) {
+  vector<Object*> work = {obj};
+  vector<Object*> refs;
+
+  while (!work.empty()) {
+    auto x = work.back();
+    work.pop_back();
+
+    if (x->ref_count != 1)
+      return false;
+
+    switch (x->type.kind) {
+    // objects in columns are not traced. (also from ObjRowRef, via vector)
+    case TypeKind::Vector:
+      if (static_cast<ObjIterable*>(x)->is_columnar())
+        return false;
+      break;
+
+    case TypeKind::Instance:
+      if (!static_cast<ObjInstance*>(x)->fields)
+        return false;
+      break;
+
+    case TypeKind::Module:
+    case TypeKind::TypeName:
+      return false;
+    }
+
+    refs.clear();
+    x->Trace(refs);
+
+    work.insert(work.end(), refs.begin(), refs.end());
+  }
+
+  return true;
+}
+
+ObjPointer make_sendable(ObjPointer obj) {
+  if (!is_unique(obj.get())) {
+    CloneMemo memo;
+
+    obj = obj->Clone();
+  }
+
+  gc::detach(obj.get());
+
+  return obj;
+}
+
+void ObjChannel::Send(ObjPointer obj, ASTPointer loc) {
+  obj = make_sendable(std::move(obj));
+
+  if (!this->channel->Send(obj))
+    throw Error(loc, "send to closed channel");
+}
+
+ObjPointer ObjChannel::Recv() {
+  auto obj = this->channel->Recv();
+
+  gc::adopt(obj.get());
+
+  return obj;
+}
+
+std::string ObjChannel::ToString() const {
+  return "<channel>";
+}
+
+} // namespace fire
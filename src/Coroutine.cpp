@@ -0,0 +1,244 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+#include <utility>
+
+#include "Coroutine.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define _FIRE_ASAN_ 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define _FIRE_ASAN_ 1
+#endif
+#endif
+
+#ifdef _FIRE_ASAN_
+#include <sanitizer/common_interface_defs.h>
+#include <sanitizer/asan_interface.h>
+#endif
+
+#if defined(__x86_64__)
+// save callee-saved registers, mxcsr and x87 control word on current stack,
+// store stack pointer to *save_sp, and restore them from load_sp.
+extern "C" void fire_switch_context(void** save_sp, void* load_sp);
+
+asm(R"(
+  .text
+  .globl fire_switch_context
+  .type fire_switch_context, @function
+fire_switch_context:
+  pushq %rbp
+  pushq %rbx
+  pushq %r12
+  pushq %r13
+  pushq %r14
+  pushq %r15
+  subq $8, %rsp
+  stmxcsr (%rsp)
+  fnstcw 4(%rsp)
+  movq %rsp, (%rdi)
+  movq %rsi, %rsp
+  ldmxcsr (%rsp)
+  fldcw 4(%rsp)
+  addq $8, %rsp
+  popq %r15
+  popq %r14
+  popq %r13
+  popq %r12
+  popq %rbx
+  popq %rbp
+  ret
+  .size fire_switch_context, .-fire_switch_context
+)");
+#endif
+
+namespace fire {
+
+// tell asan that stack is switched. (no-op without asan)
+static inline void start_switch(void** fake, void const* bottom, size_t size) {
+#ifdef _FIRE_ASAN_
+  __sanitizer_start_switch_fiber(fake, bottom, size);
+#else
+  (void)fake, (void)bottom, (void)size;
+#endif
+}
+
+static inline void finish_switch(void* fake, void const** bottom, size_t* size) {
+#ifdef _FIRE_ASAN_
+  __sanitizer_finish_switch_fiber(fake, bottom, size);
+#else
+  (void)fake, (void)bottom, (void)size;
+#endif
+}
+
+static thread_local Coroutine* g_current = nullptr;
+
+//
+// stacks of finished coroutines. (mmap / munmap are costly for generators)
+// unmapped when the thread exits. (threads of spawn() run async calls too)
+//
+struct FreeStacks {
+  vector<void*> list;
+
+  ~FreeStacks() {
+    for (auto p : this->list)
+      munmap(p, Coroutine::StackSize);
+  }
+};
+
+static thread_local FreeStacks g_free_stacks;
+
+static constexpr size_t MaxFreeStacks = 16;
+
+static void* alloc_stack() {
+  void* p;
+
+  if (!g_free_stacks.list.empty()) {
+    p = g_free_stacks.list.back();
+    g_free_stacks.list.pop_back();
+  }
+  else {
+    // pages are committed when touched.
+    p = mmap(nullptr, Coroutine::StackSize, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+
+    if (p == MAP_FAILED)
+      throw std::bad_alloc();
+
+    // guard page at bottom
+    mprotect(p, (size_t)sysconf(_SC_PAGESIZE), PROT_NONE);
+  }
+
+#ifdef _FIRE_ASAN_
+  // frames of finished coroutine are left poisoned. (also in new mapping,
+  // if its address was used by stack unmapped before)
+  ASAN_UNPOISON_MEMORY_REGION(p, Coroutine::StackSize);
+#endif
+
+  return p;
+}
+
+static void free_stack(void* p) {
+  if (g_free_stacks.list.size() < MaxFreeStacks)
+    g_free_stacks.list.emplace_back(p);
+  else
+    munmap(p, Coroutine::StackSize);
+}
+
+Coroutine::Coroutine(std::function<void()> body)
+    : body(std::move(body)) {
+}
+
+Coroutine::~Coroutine() {
+  if (this->started && !this->done) {
+    this->canceled = true;
+    this->Resume();
+  }
+
+  if (this->stack)
+    free_stack(this->stack);
+}
+
+void Coroutine::init_context(Context& ctx, void* stack, size_t size) {
+#if defined(__x86_64__)
+  // frame popped by fire_switch_context, and then returns to entry.
+  auto top = (u64*)(((uintptr_t)stack + size) & ~(uintptr_t)15);
+
+  top -= 2;
+  top[0] = (u64)(uintptr_t)entry; // return address (rsp + 8 is aligned at entry)
+  top[1] = 0;
+
+  top -= 6; // rbp, rbx, r12 - r15
+  std::fill(top, top + 6, 0);
+
+  top -= 1;
+  *top = 0x1F80 | ((u64)0x037F << 32); // default mxcsr, x87 control word
+
+  ctx.sp = top;
+#else
+  getcontext(&ctx.uc);
+
+  ctx.uc.uc_stack.ss_sp = stack;
+  ctx.uc.uc_stack.ss_size = size;
+  ctx.uc.uc_link = nullptr;
+
+  makecontext(&ctx.uc, entry, 0);
+#endif
+}
+
+void Coroutine::switch_context(Context& from, Context& to) {
+#if defined(__x86_64__)
+  fire_switch_context(&from.sp, to.sp);
+#else
+  swapcontext(&from.uc, &to.uc);
+#endif
+}
+
+void Coroutine::entry() {
+  auto self = g_current;
+
+  finish_switch(nullptr, &self->caller_bottom, &self->caller_size);
+
+  try {
+    self->body();
+  }
+  catch (Cancel) {
+  }
+  catch (...) {
+    self->error = std::current_exception();
+  }
+
+  self->body = nullptr;
+  self->done = true;
+
+  start_switch(nullptr, self->caller_bottom, self->caller_size);
+  switch_context(self->context, self->caller);
+}
+
+void Coroutine::Resume() {
+  assert(!this->done);
+
+  if (!this->started) {
+    this->stack = alloc_stack();
+    this->started = true;
+
+    init_context(this->context, this->stack, StackSize);
+  }
+
+  this->prev = g_current;
+  g_current = this;
+
+  void* fake = nullptr;
+
+  start_switch(&fake, this->stack, StackSize);
+  switch_context(this->caller, this->context);
+  finish_switch(fake, nullptr, nullptr);
+
+  g_current = this->prev;
+
+  if (this->error)
+    std::rethrow_exception(std::exchange(this->error, nullptr));
+}
+
+void Coroutine::Suspend() {
+  auto self = g_current;
+
+  assert(self);
+
+  start_switch(&self->fake_stack, self->caller_bottom, self->caller_size);
+  switch_context(self->context, self->caller);
+  finish_switch(self->fake_stack, &self->caller_bottom, &self->caller_size);
+
+  if (self->canceled)
+    throw Cancel();
+}
+
+Coroutine* Coroutine::Current() {
+  return g_current;
+}
+
+} // namespace fire
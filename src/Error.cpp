@@ -1,3 +1,4 @@
+#include <atomic>
 #include <iostream>
 
 #include "alert.h"
@@ -30,10 +31,12 @@ struct line_data_wrapper_t {
 
   line_data_wrapper_t(Token const& tok)
       : src(tok.sourceloc.ref) {
-    this->index = tok.sourceloc.line.index;
-    this->pos = tok.sourceloc.pos_in_line;
+    auto line = tok.sourceloc.GetLineRange();
 
-    this->view = tok.sourceloc.GetLine();
+    this->index = line.index;
+    this->pos = tok.sourceloc.position - line.begin;
+
+    this->view = this->src->GetLineView(line);
     this->linenum = this->index + 1;
   }
 
@@ -78,7 +81,7 @@ struct line_data_wrapper_t {
   }
 };
 
-static int _err_emitted_count = 0;
+static std::atomic<int> _err_emitted_count = 0;
 
 Error const& Error::emit() const {
 
@@ -0,0 +1,99 @@
+#include "Builtin.h"
+#include "Evaluator.h"
+#include "Error.h"
+#include "Coroutine.h"
+#include "EventLoop.h"
+
+namespace fire::eval {
+
+//
+// call of async function.
+//  (referenced by callbacks in event loop, see resume_task)
+//
+struct Evaluator::Task : Fiber, std::enable_shared_from_this<Task> {};
+
+ObjPtr<ObjFuture> Evaluator::call_async(ASTPtr<AST::Function> func, ObjVector args,
+                                        ASTPointer loc) {
+  auto state = std::make_shared<io::FutureState>();
+  auto task = std::make_shared<Task>();
+
+  // global variables
+  task->var_stack.emplace_back(*this->var_stack.rbegin());
+
+  task->co = std::make_unique<Coroutine>(
+      [this, state, func, args = std::move(args), loc]() mutable {
+        try {
+          state->resolve(this->run_function(func, std::move(args), loc));
+        }
+        catch (Coroutine::Cancel) {
+          throw;
+        }
+        catch (...) {
+          state->reject(std::current_exception());
+        }
+      });
+
+  io::EventLoop::get().post([this, task] { this->resume_task(task); });
+
+  // (type is set by Sema)
+  return ObjNew<ObjFuture>(func->return_type->type, state);
+}
+
+void Evaluator::resume(Fiber& fiber) {
+  auto swap_frames = [this, &fiber] {
+    std::swap(this->var_stack, fiber.var_stack);
+    std::swap(this->call_stack, fiber.call_stack);
+    std::swap(this->loops, fiber.loops);
+  };
+
+  swap_frames();
+
+  try {
+    fiber.co->Resume();
+  }
+  catch (...) {
+    swap_frames();
+    throw;
+  }
+
+  swap_frames();
+}
+
+void Evaluator::resume_task(std::shared_ptr<Task> task) {
+  auto prev = this->cur_task;
+
+  this->cur_task = task.get();
+
+  // body of task catches all exceptions.
+  this->resume(*task);
+
+  this->cur_task = prev;
+}
+
+ObjPointer Evaluator::await(ObjPtr<ObjFuture> future, ASTPointer loc) {
+  auto state = future->state;
+
+  if (!state->done) {
+    if (this->cur_task && Coroutine::Current() == this->cur_task->co.get()) {
+      state->waiters.emplace_back(
+          [this, task = this->cur_task->shared_from_this()] { this->resume_task(task); });
+
+      Coroutine::Suspend();
+    }
+    else {
+      auto& loop = io::EventLoop::get();
+
+      while (!state->done) {
+        if (!loop.run_once())
+          throw Error(loc, "awaited future is never completed");
+      }
+    }
+  }
+
+  if (state->error)
+    std::rethrow_exception(state->error);
+
+  return state->result;
+}
+
+} // namespace fire::eval
@@ -29,7 +29,11 @@ static inline ObjPtr<ObjIterable> multiply_array(ObjPtr<ObjIterable> s, i64 n) {
 static inline ObjPtr<ObjIterable> add_vec_wrap(ObjPtr<ObjIterable> v, ObjPointer e) {
   v = PtrCast<ObjIterable>(v->Clone());
 
-  v->Append(e);
+  // fields of e are copied into new row
+  if (v->is_columnar())
+    v->columns->Append(PtrCast<ObjInstance>(e));
+  else
+    v->Append(e);
 
   return v;
 }
@@ -44,10 +48,16 @@ ObjPointer Evaluator::eval_expr(ASTPtr<AST::Expr> ast) {
 
   case Kind::Add: {
 
-    if (lhs->is_vector() && rhs->is_int())
+    if (ast->is_concat) {
+      lhs = lhs->Clone();
+      lhs->As<ObjIterable>()->AppendList(PtrCast<ObjIterable>(rhs));
+      return lhs;
+    }
+
+    if (lhs->is_vector())
       return add_vec_wrap(PtrCast<ObjIterable>(lhs), rhs);
 
-    if (rhs->is_vector() && lhs->is_int())
+    if (rhs->is_vector())
       return add_vec_wrap(PtrCast<ObjIterable>(rhs), lhs);
 
     switch (lhs->type.kind) {
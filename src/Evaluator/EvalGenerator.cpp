@@ -0,0 +1,65 @@
+#include "Builtin.h"
+#include "Evaluator.h"
+#include "Error.h"
+
+namespace fire::eval {
+
+//
+// call of generator function.
+//  value is set by each yield. (see Kind::Yield in eval_stmt)
+//
+struct GeneratorState : Evaluator::Fiber {
+  ObjPointer value = nullptr;
+};
+
+ObjPtr<ObjGenerator> Evaluator::make_generator(ASTPtr<AST::Function> func, ObjVector args,
+                                               ASTPointer loc) {
+  auto state = std::make_shared<GeneratorState>();
+
+  // global variables
+  state->var_stack.emplace_back(*this->var_stack.rbegin());
+
+  // started by first next()
+  state->co = std::make_unique<Coroutine>([this, func, args = std::move(args), loc]() mutable {
+    this->run_function(func, std::move(args), loc);
+  });
+
+  // (type is set by Sema)
+  return ObjNew<ObjGenerator>(func->return_type->type, state);
+}
+
+bool Evaluator::next(ObjPtr<ObjGenerator> gen, ObjPointer& out) {
+  auto& state = *gen->state;
+
+  if (state.co->is_done())
+    return false;
+
+  auto prev = this->cur_generator;
+
+  this->cur_generator = &state;
+
+  try {
+    this->resume(state);
+  }
+  catch (...) {
+    this->cur_generator = prev;
+    throw;
+  }
+
+  this->cur_generator = prev;
+
+  if (state.co->is_done())
+    return false;
+
+  out = std::move(state.value);
+
+  return true;
+}
+
+void Evaluator::yield(ObjPointer value) {
+  this->cur_generator->value = std::move(value);
+
+  Coroutine::Suspend();
+}
+
+} // namespace fire::eval
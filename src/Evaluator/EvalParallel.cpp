@@ -0,0 +1,310 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+#include "Builtin.h"
+#include "Evaluator.h"
+#include "Error.h"
+#include "GC.h"
+
+namespace fire::eval {
+
+//
+// threads for parallel for. (shared by all evaluators)
+//
+//  try_run(job) runs job on all threads and on caller, and waits for them.
+//  only one loop uses the threads at a time, so a loop started on other
+//  thread at the same time runs on its caller only.
+//
+struct ParallelPool {
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::condition_variable cv_done;
+
+  // held while a loop is running
+  std::mutex busy;
+
+  std::function<void()> const* job = nullptr;
+
+  u64 generation = 0;
+  size_t running = 0;
+
+  bool stop = false;
+
+  vector<std::thread> threads;
+
+  size_t count() {
+    std::call_once(this->started, [this] {
+      auto n = std::thread::hardware_concurrency();
+
+      for (u32 i = 1; i < n; i++)
+        this->threads.emplace_back([this] { this->run(); });
+    });
+
+    return this->threads.size();
+  }
+
+  bool try_run(std::function<void()> const& fn) {
+    std::unique_lock lock_busy(this->busy, std::try_to_lock);
+
+    if (!lock_busy.owns_lock() || this->count() == 0)
+      return false;
+
+    {
+      std::lock_guard lock(this->mtx);
+
+      this->job = &fn;
+      this->running = this->threads.size();
+      this->generation++;
+    }
+
+    this->cv.notify_all();
+
+    fn();
+
+    std::unique_lock lock(this->mtx);
+
+    this->cv_done.wait(lock, [this] { return this->running == 0; });
+    this->job = nullptr;
+
+    return true;
+  }
+
+  void run() {
+    // objects made here are adopted by thread of the loop. (see parallel_for)
+    gc::next_collect = SIZE_MAX;
+
+    u64 seen = 0;
+
+    while (true) {
+      std::function<void()> const* fn;
+
+      {
+        std::unique_lock lock(this->mtx);
+
+        this->cv.wait(lock, [&] { return this->stop || this->generation != seen; });
+
+        if (this->stop)
+          return;
+
+        seen = this->generation;
+        fn = this->job;
+      }
+
+      (*fn)();
+
+      std::lock_guard lock(this->mtx);
+
+      if (--this->running == 0)
+        this->cv_done.notify_one();
+    }
+  }
+
+  ~ParallelPool() {
+    {
+      std::lock_guard lock(this->mtx);
+      this->stop = true;
+    }
+
+    this->cv.notify_all();
+
+    for (auto&& t : this->threads)
+      t.join();
+  }
+
+private:
+  std::once_flag started;
+};
+
+static ParallelPool g_pool;
+
+// iterations are divided into chunks of this count per thread,
+// so a thread which finishes early takes chunks left by others.
+static constexpr size_t ChunksPerThread = 8;
+
+static ObjPointer reduce_identity(TypeInfo const& type, ASTKind op) {
+  if (type.kind == TypeKind::Float)
+    return ObjNew<ObjPrimitive>(op == ASTKind::Mul ? 1.0 : 0.0);
+
+  return ObjNew<ObjPrimitive>((i64)(op == ASTKind::Mul ? 1 : 0));
+}
+
+static ObjPointer reduce(TypeInfo const& type, ASTKind op, ObjPointer const& a,
+                         ObjPointer const& b) {
+  if (type.kind == TypeKind::Float) {
+    auto x = a->get_vf(), y = b->get_vf();
+    return ObjNew<ObjPrimitive>(op == ASTKind::Mul ? x * y : x + y);
+  }
+
+  auto x = a->get_vi(), y = b->get_vi();
+  return ObjNew<ObjPrimitive>((i64)(op == ASTKind::Mul ? x * y : x + y));
+}
+
+void Evaluator::parallel_for(ASTPtr<AST::Statement> ast) {
+  auto d = ast->data_parallel_for;
+
+  i64 begin = this->evaluate(d->begin)->get_vi();
+  i64 end = this->evaluate(d->end)->get_vi();
+
+  if (begin >= end)
+    return;
+
+  size_t count = (size_t)(end - begin);
+  size_t chunk_size = std::max<size_t>(1, count / ((g_pool.count() + 1) * ChunksPerThread));
+  size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+
+  // reduction: each chunk starts from identity, and results of chunks are
+  // combined in order of chunks after the loop. (same result for any threads)
+  auto acc_id = d->acc ? d->acc->GetID() : nullptr;
+  vector<ObjPointer> partials(d->acc ? chunk_count : 0);
+
+  auto frames = this->var_stack;
+
+  std::atomic<size_t> next_chunk = 0;
+  std::atomic<bool> failed = false;
+
+  // first error (thrown object or Error)
+  std::mutex mtx;
+  ObjPointer thrown = nullptr;
+  std::exception_ptr error = nullptr;
+
+  auto run_chunks = [&](Evaluator& ev) {
+    auto saved = std::move(ev.var_stack);
+
+    while (!failed) {
+      size_t c = next_chunk++;
+
+      if (c >= chunk_count)
+        break;
+
+      ev.var_stack = frames;
+
+      VarStackPtr acc_frame = nullptr;
+      size_t acc_index = 0;
+
+      // own copy of frame which has accumulator
+      if (acc_id) {
+        auto it = std::next(ev.var_stack.begin(), acc_id->distance);
+
+        *it = acc_frame = std::make_shared<VarStack>(**it);
+
+        acc_index = (size_t)(acc_id->index + acc_id->index_add);
+        acc_frame->var_list[acc_index] = reduce_identity(d->_acc_type, d->op);
+      }
+
+      i64 lo = begin + (i64)(c * chunk_size);
+      i64 hi = std::min(end, lo + (i64)chunk_size);
+
+      auto stack = ev.push_stack(1);
+
+      try {
+        for (i64 i = lo; i < hi && !failed; i++) {
+          stack->var_list[0] = ObjNew<ObjPrimitive>(i);
+          ev.eval_stmt(d->block);
+        }
+      }
+      catch (ObjPointer obj) {
+        std::lock_guard lock(mtx);
+
+        if (!failed.exchange(true))
+          thrown = std::move(obj);
+      }
+      catch (...) {
+        std::lock_guard lock(mtx);
+
+        if (!failed.exchange(true))
+          error = std::current_exception();
+      }
+
+      if (acc_frame)
+        partials[c] = std::move(acc_frame->var_list[acc_index]);
+
+      ev.var_stack.clear();
+    }
+
+    ev.var_stack = std::move(saved);
+  };
+
+  // objects shared by threads
+  vector<Object*> frozen;
+
+  // objects made by other threads, and objects to delete after unfreeze
+  vector<Object*> adopted;
+  vector<Object*> deferred;
+
+  auto caller = std::this_thread::get_id();
+
+  std::function<void()> job = [&] {
+    if (std::this_thread::get_id() == caller) {
+      run_chunks(*this);
+      return;
+    }
+
+    {
+      Evaluator ev;
+
+      // constants in AST are not frozen
+      ev.is_isolate = true;
+
+      run_chunks(ev);
+    }
+
+    auto objs = gc::detach_thread();
+    auto dfr = gc::take_deferred();
+
+    std::lock_guard lock(mtx);
+
+    adopted.insert(adopted.end(), objs.begin(), objs.end());
+    deferred.insert(deferred.end(), dfr.begin(), dfr.end());
+  };
+
+  auto freeze_frames = [&frozen](std::list<VarStackPtr> const& list) {
+    for (auto&& s : list) {
+      for (auto&& v : s->var_list)
+        gc::freeze(v.get(), frozen);
+
+      gc::freeze(s->func_result.get(), frozen);
+    }
+  };
+
+  freeze_frames(this->var_stack);
+  freeze_frames(this->call_stack);
+
+  // blocks freed on this thread are mostly made by threads of previous loop,
+  // give them back. (see alloc::refill)
+  alloc::release_thread();
+
+  // collector of this thread must not visit objects being changed by others
+  auto saved_next_collect = std::exchange(gc::next_collect, SIZE_MAX);
+
+  if (!g_pool.try_run(job))
+    run_chunks(*this);
+
+  gc::next_collect = saved_next_collect;
+
+  for (auto&& obj : adopted)
+    gc::adopt(obj);
+
+  auto dfr = gc::take_deferred();
+
+  deferred.insert(deferred.end(), dfr.begin(), dfr.end());
+
+  gc::unfreeze(frozen, deferred);
+
+  if (thrown)
+    throw thrown;
+
+  if (error)
+    std::rethrow_exception(error);
+
+  if (acc_id) {
+    auto& acc = this->eval_as_left(d->acc);
+
+    for (auto&& p : partials)
+      acc = reduce(d->_acc_type, d->op, acc, p);
+  }
+}
+
+} // namespace fire::eval
@@ -1,11 +1,88 @@
 #include "Builtin.h"
 #include "Evaluator.h"
 #include "Error.h"
+#include "GC.h"
 
 #define CAST(T) auto x = ASTCast<AST::T>(ast)
 
 namespace fire::eval {
 
+//
+// evaluate block of the pattern if cond matches to it.
+//  is_equal = pattern is already known to be equal to cond (by decision tree)
+//
+bool Evaluator::eval_match_arm(AST::Match::Pattern const& P, ObjPointer const& cond,
+                               bool is_equal) {
+  using Type = AST::Match::Pattern::Type;
+
+  switch (P.type) {
+  case Type::ExprEval: {
+    this->push_stack(0);
+
+    if (!is_equal && !cond->Equals(this->evaluate(P.expr))) {
+      this->pop_stack();
+      return false;
+    }
+
+    break;
+  }
+
+  case Type::Variable:
+    this->push_stack(1)->var_list[0] = cond;
+    break;
+
+  case Type::EnumeratorWithArguments: {
+    auto cf = P.expr->As<AST::CallFunc>();
+    auto id = cf->callee->GetID();
+
+    auto e = cond->As<ObjEnumerator>();
+
+    if (e->index != (int)id->index)
+      return false;
+
+    auto stack = this->push_stack(P.vardef_list.size());
+
+    // payload is bound without copy
+    if (id->ast_enum->enumerators[id->index].data_type ==
+        AST::Enum::Enumerator::DataType::Value) {
+      if (!P.vardef_list.empty())
+        stack->var_list[0] = e->data;
+      else if (!this->evaluate(cf->args[0])->Equals(e->data))
+        goto _match_failure;
+
+      break;
+    }
+
+    for (size_t i = 0, j = 0; i < cf->args.size(); i++) {
+      auto& list = e->data->As<ObjIterable>()->list;
+
+      if (j < P.vardef_list.size() && P.vardef_list[j].first == i)
+        stack->var_list[j++] = list[i];
+      else if (!this->evaluate(cf->args[i])->Equals(list[i]))
+        goto _match_failure;
+    }
+
+    break;
+  }
+
+  case Type::AllCases:
+    this->push_stack(0);
+    break;
+
+  default:
+    todo_impl;
+  }
+
+  this->eval_stmt(P.block);
+
+  this->pop_stack();
+  return true;
+
+_match_failure:
+  this->pop_stack();
+  return false;
+}
+
 void Evaluator::eval_stmt(ASTPointer ast) {
   using Kind = ASTKind;
 
@@ -33,6 +110,10 @@ void Evaluator::eval_stmt(ASTPointer ast) {
     break;
   }
 
+  case Kind::Yield:
+    this->yield(this->evaluate(ast->as_stmt()->expr));
+    break;
+
   case Kind::Throw:
     throw this->evaluate(ast->as_stmt()->expr);
 
@@ -54,6 +135,8 @@ void Evaluator::eval_stmt(ASTPointer ast) {
 
       if (stack->returned)
         break;
+
+      gc::safepoint();
     }
 
     this->pop_stack();
@@ -85,108 +168,142 @@ void Evaluator::eval_stmt(ASTPointer ast) {
   }
 
   case Kind::Match: {
+    using Dispatch = AST::Match::Dispatch;
+
     auto x = ASTCast<AST::Match>(ast);
 
     auto cond = this->evaluate(x->cond);
 
-    for (auto&& P : x->patterns) {
-      switch (P.type) {
-      case AST::Match::Pattern::Type::ExprEval: {
-        if (cond->Equals(this->evaluate(P.expr))) {
-          this->push_stack(0);
-          break;
-        }
-
-        continue;
-      }
-
-      case AST::Match::Pattern::Type::Variable: {
-        auto S = this->push_stack(1);
+    switch (x->dispatch) {
+    case Dispatch::Linear:
+      for (auto&& P : x->patterns)
+        if (this->eval_match_arm(P, cond, false))
+          return;
 
-        S->var_list.emplace_back(cond);
+      return;
 
-        // this->eval_stmt(P.block);
+    case Dispatch::Enumerator:
+      for (u32 i : x->enum_table[cond->As<ObjEnumerator>()->index]) {
+        auto& P = x->patterns[i];
 
-        // this->pop_stack();
-        break;
+        if (this->eval_match_arm(P, cond, P.expr->kind == ASTKind::Enumerator))
+          return;
       }
 
-      case AST::Match::Pattern::Type::Enumerator: {
+      break;
 
-        // this is Type::ExprEval ... ?
+    case Dispatch::Table: {
+      // (wraps around if cond < table_base)
+      u64 k = (u64)cond->As<ObjPrimitive>()->as_integer() - (u64)x->table_base;
 
-        todo_impl;
+      if (k < x->table.size() && x->table[k] != -1) {
+        this->eval_match_arm(x->patterns[x->table[k]], cond, true);
+        return;
+      }
 
-        break;
+      break;
+    }
+
+    case Dispatch::Hash:
+      if (auto p = x->hash.find(cond); p) {
+        this->eval_match_arm(x->patterns[*p], cond, true);
+        return;
       }
 
-      case AST::Match::Pattern::Type::EnumeratorWithArguments: {
+      break;
+    }
 
-        auto iter = P.vardef_list.begin();
+    if (x->fallback != -1)
+      this->eval_match_arm(x->patterns[x->fallback], cond, true);
 
-        auto cf = P.expr->As<AST::CallFunc>();
+    break;
+  }
+
+  case Kind::While: {
+    auto d = ast->as_stmt()->data_while;
 
-        auto eor_id = cf->callee->GetID();
+    while (this->evaluate(d->cond)->get_vb()) {
+      this->evaluate(d->block);
+    }
 
-        auto ep = eor_id->ast_enum;
-        auto ei = eor_id->index;
+    break;
+  }
 
-        auto e_ref = ep->enumerators[ei];
+  case Kind::ForEach: {
+    auto d = ast->as_stmt()->data_for_each;
 
-        auto stack = this->push_stack(P.vardef_list.size());
+    auto iterable = this->evaluate(d->iterable);
 
-        auto obj_to_cmp = PtrCast<ObjEnumerator>(cond->Clone());
+    if (iterable->type.kind == TypeKind::Channel) {
+      auto stack = this->push_stack(1);
 
-        if (e_ref.data_type == AST::Enum::Enumerator::DataType::Value) {
-          stack->var_list[0] = obj_to_cmp->data;
-        }
-        else {
-          auto& list = obj_to_cmp->data->As<ObjIterable>()->list;
-
-          for (size_t i = 0, j = 0; i < cf->args.size(); i++) {
-            if (iter != P.vardef_list.end() && iter->first == i) {
-              stack->var_list[j++] = list[i];
-              iter++;
-            }
-            else {
-              if (!this->evaluate(cf->args[i])->Equals(list[i])) {
-                goto _match_failure;
-              }
-            }
-          }
-        }
+      while (auto obj = iterable->As<ObjChannel>()->Recv()) {
+        stack->var_list[0] = std::move(obj);
 
-        break;
-      }
+        this->eval_stmt(d->block);
 
-      case AST::Match::Pattern::Type::AllCases: {
-        this->push_stack(0);
-        break;
-      }
+        if (stack->returned)
+          break;
       }
 
-      this->eval_stmt(P.block);
-
       this->pop_stack();
+
       break;
+    }
+
+    if (iterable->type.kind == TypeKind::Generator) {
+      auto gen = PtrCast<ObjGenerator>(iterable);
+
+      // resumed by threads at same time
+      if (gen->is_frozen)
+        throw Error(d->iterable, "cannot resume generator shared by parallel for");
+
+      auto stack = this->push_stack(1);
+
+      for (ObjPointer obj = nullptr; this->next(gen, obj);) {
+        stack->var_list[0] = std::move(obj);
+
+        this->eval_stmt(d->block);
+
+        if (stack->returned)
+          break;
+      }
 
-    _match_failure:;
       this->pop_stack();
+
+      break;
     }
 
-    break;
-  }
+    bool columnar = iterable->is_vector() && iterable->As<ObjIterable>()->is_columnar();
 
-  case Kind::While: {
-    auto d = ast->as_stmt()->data_while;
+    // copy of elements, the block may modify the iterable.
+    // (columnar vector makes reference to each row instead)
+    ObjVector items = iterable->is_dict() ? iterable->As<ObjDict>()->Keys()
+                      : columnar          ? ObjVector()
+                                          : iterable->As<ObjIterable>()->list;
 
-    while (this->evaluate(d->cond)->get_vb()) {
-      this->evaluate(d->block);
+    size_t count = columnar ? iterable->As<ObjIterable>()->Count() : items.size();
+
+    auto stack = this->push_stack(1);
+
+    for (size_t i = 0; i < count; i++) {
+      stack->var_list[0] = columnar ? iterable->As<ObjIterable>()->At(i) : items[i];
+
+      this->eval_stmt(d->block);
+
+      if (stack->returned)
+        break;
     }
 
+    this->pop_stack();
+
     break;
   }
 
+  case Kind::ParallelFor:
+    this->parallel_for(ASTCast<AST::Statement>(ast));
+    break;
+
   case Kind::TryCatch: {
     auto d = ast->as_stmt()->data_try_catch;
 
@@ -230,6 +347,35 @@ void Evaluator::eval_stmt(ASTPointer ast) {
   case Kind::Vardef: {
     CAST(VarDef);
 
+    if (!x->unpack.empty()) {
+      auto& var_list = this->get_cur_stack().var_list;
+
+      // let (a, b) = (x, y);
+      //  assign elements directly, without making a tuple object.
+      //  all elements are evaluated before assign. (for "(b, a)")
+      if (x->init->kind == ASTKind::Tuple) {
+        auto& elements = x->init->As<AST::Tuple>()->elements;
+
+        ObjVector values;
+
+        for (auto&& e : elements)
+          values.emplace_back(this->evaluate(e));
+
+        for (size_t i = 0; i < values.size(); i++)
+          var_list[x->unpack[i]->index + x->unpack[i]->index_add] = std::move(values[i]);
+
+        break;
+      }
+
+      auto tuple = this->evaluate(x->init);
+
+      for (size_t i = 0; i < x->unpack.size(); i++)
+        var_list[x->unpack[i]->index + x->unpack[i]->index_add] =
+            tuple->As<ObjTuple>()->Get(i);
+
+      break;
+    }
+
     if (x->init) {
       this->get_cur_stack().var_list[x->index + x->index_add] = this->evaluate(x->init);
     }
@@ -0,0 +1,158 @@
+#include <thread>
+#include <mutex>
+#include <exception>
+
+#include "Builtin.h"
+#include "Evaluator.h"
+#include "Error.h"
+#include "GC.h"
+#include "EventLoop.h"
+
+namespace fire {
+
+struct ThreadState {
+  std::thread thread;
+  std::mutex mtx;
+
+  bool joined = false;
+
+  // set by the thread. (detached from gc of the thread)
+  ObjPointer result = nullptr;
+  ObjPointer thrown = nullptr;
+  std::exception_ptr error = nullptr;
+
+  ~ThreadState() {
+    if (this->thread.joinable())
+      this->thread.join();
+  }
+};
+
+ObjPointer ObjThread::Join(ASTPointer loc) {
+  std::lock_guard lock(this->state->mtx);
+
+  if (this->state->joined)
+    throw Error(loc, "thread is already joined");
+
+  this->state->thread.join();
+  this->state->joined = true;
+
+  if (this->state->error)
+    std::rethrow_exception(this->state->error);
+
+  if (auto obj = std::move(this->state->thrown); obj) {
+    gc::adopt(obj.get());
+    throw obj;
+  }
+
+  auto result = std::move(this->state->result);
+
+  gc::adopt(result.get());
+
+  return result;
+}
+
+std::string ObjThread::ToString() const {
+  return "<thread>";
+}
+
+} // namespace fire
+
+namespace fire::eval {
+
+// copy of obj which is not tracked by gc of this thread.
+static ObjPointer copy_for_thread(ObjPointer const& obj) {
+  if (!obj)
+    return nullptr;
+
+  auto copy = obj->Clone();
+
+  gc::detach(copy.get());
+
+  return copy;
+}
+
+ObjPtr<ObjThread> Evaluator::spawn(ObjPtr<ObjCallable> callable, ObjVector args,
+                                   ASTPtr<AST::CallFunc> ast) {
+  auto state = std::make_shared<ThreadState>();
+
+  auto type = TypeInfo(TypeKind::Thread, {callable->type->params[0]});
+  auto handle = ObjNew<ObjThread>(type, state);
+
+  ObjPtr<ObjCallable> func;
+  ObjVector globals;
+
+  {
+    // one memo for all, so references between them are kept.
+    // (memo must be freed before the thread starts)
+    CloneMemo memo;
+
+    func = PtrCast<ObjCallable>(callable->Clone());
+
+    func->selfobj = copy_for_thread(func->selfobj);
+    gc::detach(func.get());
+
+    for (auto&& arg : args)
+      arg = copy_for_thread(arg);
+
+    for (auto&& var : (*this->var_stack.rbegin())->var_list)
+      globals.emplace_back(copy_for_thread(var));
+  }
+
+  // handle waits for the thread in ~ThreadState, so state outlives the thread.
+  auto run = [state = state.get(), ast, func = std::move(func), args = std::move(args),
+              globals = std::move(globals)]() mutable {
+    gc::adopt(func.get());
+
+    for (auto&& x : args)
+      gc::adopt(x.get());
+
+    for (auto&& x : globals)
+      gc::adopt(x.get());
+
+    {
+      Evaluator ev;
+
+      ev.is_isolate = true;
+      ev.push_stack(0)->var_list = std::move(globals);
+
+      // async calls refer to ev, so they don't remain after this thread.
+      // (same as execute_script in main)
+      try {
+        if (func->builtin)
+          state->result = func->builtin->Call(ast, std::move(args));
+        else
+          state->result = ev.call_function(func->func, std::move(args), ast);
+
+        // not awaited yet
+        while (io::EventLoop::get().run_once())
+          ;
+      }
+      catch (ObjPointer obj) {
+        io::EventLoop::get().cancel_all();
+        state->thrown = obj;
+      }
+      catch (...) {
+        io::EventLoop::get().cancel_all();
+        state->error = std::current_exception();
+      }
+
+      func = nullptr;
+      ev.pop_stack();
+    }
+
+    gc::detach(state->result.get());
+    gc::detach(state->thrown.get());
+
+    // free cycles, and leave others to joining thread.
+    gc::collect();
+    gc::release_thread();
+
+    alloc::release_thread();
+  };
+
+  state->thread = std::thread(std::move(run));
+
+  return handle;
+}
+
+} // namespace fire::eval
@@ -6,13 +6,21 @@
 
 namespace fire::eval {
 
-ObjPtr<ObjNone> Evaluator::_None;
+// each thread has own evaluator. (see spawn)
+static thread_local vector<Evaluator*> _evaluator_instances;
+
+Evaluator* Evaluator::GetInstance() {
+  return *_evaluator_instances.rbegin();
+}
 
 Evaluator::Evaluator() {
   _None = ObjNew<ObjNone>();
+
+  _evaluator_instances.emplace_back(this);
 }
 
 Evaluator::~Evaluator() {
+  _evaluator_instances.pop_back();
 }
 
 Evaluator::VarStackPtr Evaluator::push_stack(size_t var_count) {
@@ -39,15 +47,6 @@ Evaluator::VarStack& Evaluator::get_stack(int distance) {
 }
 
 ObjPointer& Evaluator::eval_as_left(ASTPointer ast) {
-
-  switch (ast->kind) {
-  case ASTKind::IndexRef: {
-    auto ex = ast->as_expr();
-
-    return this->eval_index_ref(this->eval_as_left(ex->lhs), this->evaluate(ex->rhs));
-  }
-  }
-
   assert(ast->kind == ASTKind::Variable);
 
   auto x = ast->GetID();
@@ -55,20 +54,88 @@ ObjPointer& Evaluator::eval_as_left(ASTPointer ast) {
   return this->get_stack(x->distance).var_list[x->index + x->index_add];
 }
 
-ObjPointer& Evaluator::eval_index_ref(ObjPointer array, ObjPointer _index_obj) {
+ObjPointer& Evaluator::eval_index_ref(ASTPtr<AST::Expr> ast, ObjPointer array,
+                                      ObjPointer _index_obj) {
+  switch (array->type.kind) {
+  case TypeKind::Dict: {
+    if (auto pval = array->As<ObjDict>()->Find(_index_obj); pval)
+      return *pval;
+
+    throw Error(ast->rhs, "key '" + _index_obj->ToStringAsMember() + "' not found");
+  }
+
+  // index is checked in Sema
+  case TypeKind::Tuple:
+    return array->As<ObjTuple>()->Get((size_t)_index_obj->As<ObjPrimitive>()->vi);
+  }
+
   assert(_index_obj->type.kind == TypeKind::Int);
+  assert(array->type.kind == TypeKind::Vector);
 
   i64 index = _index_obj->As<ObjPrimitive>()->vi;
 
-  switch (array->type.kind) {
-  case TypeKind::Dict: {
-    todo_impl;
+  auto& list = array->As<ObjIterable>()->list;
+
+  if (index < 0 || index >= (i64)list.size())
+    throw Error(ast->rhs, "index out of range");
+
+  return list[(size_t)index];
+}
+
+ObjPointer Evaluator::eval_member_owner(ASTPointer ast, i64& row) {
+  row = -1;
+
+  if (ast->kind != ASTKind::IndexRef)
+    return this->evaluate(ast);
+
+  auto ex = ASTCast<AST::Expr>(ast);
+
+  auto array = this->evaluate(ex->lhs);
+  auto index = this->evaluate(ex->rhs);
+
+  if (array->is_vector() && array->As<ObjIterable>()->is_columnar()) {
+    if (index->get_vi() < 0 || index->get_vi() >= (i64)array->As<ObjIterable>()->Count())
+      throw Error(ex->rhs, "index out of range");
+
+    row = index->get_vi();
+
+    return array;
   }
+
+  return this->eval_index_ref(ex, array, index);
+}
+
+ObjPointer Evaluator::call_function(ASTPtr<AST::Function> func, ObjVector args,
+                                    ASTPointer loc) {
+  if (func->is_async)
+    return this->call_async(func, std::move(args), loc);
+
+  if (func->is_generator)
+    return this->make_generator(func, std::move(args), loc);
+
+  return this->run_function(func, std::move(args), loc);
+}
+
+ObjPointer Evaluator::run_function(ASTPtr<AST::Function> func, ObjVector args,
+                                   ASTPointer loc) {
+  auto stack = this->push_stack(args.size());
+
+  if (this->var_stack.size() >= 1588) {
+    throw Error(loc ? loc->token : func->token, "stack overflow");
   }
 
-  assert(array->type.kind == TypeKind::Vector);
+  this->call_stack.push_front(stack);
+
+  stack->var_list = std::move(args);
+
+  this->evaluate(func->block);
 
-  return array->As<ObjIterable>()->list[(size_t)index];
+  auto result = stack->func_result;
+
+  this->pop_stack();
+  this->call_stack.pop_front();
+
+  return result ? result : _None;
 }
 
 ObjPointer Evaluator::evaluate(ASTPointer ast) {
@@ -94,6 +161,10 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
     panic;
 
   case Kind::Value: {
+    // count of objects in AST is changed only by main thread.
+    if (this->is_isolate)
+      return ast->as_value()->value->Clone();
+
     return ast->as_value()->value;
   }
 
@@ -111,10 +182,47 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
     return obj;
   }
 
+  case Kind::Tuple: {
+    CAST(Tuple);
+
+    auto obj = ObjNew<ObjTuple>(x->type, x->elements.size());
+
+    for (size_t i = 0; i < x->elements.size(); i++)
+      obj->Get(i) = this->evaluate(x->elements[i]);
+
+    return obj;
+  }
+
+  case Kind::Dict: {
+    CAST(Dict);
+
+    auto obj = ObjNew<ObjDict>(x->type);
+
+    obj->table.reserve(x->elements.size());
+
+    for (auto&& [k, v] : x->elements)
+      obj->Insert(this->evaluate(k), this->evaluate(v));
+
+    return obj;
+  }
+
   case Kind::IndexRef: {
-    auto ex = ast->as_expr();
+    auto ex = ASTCast<AST::Expr>(ast);
 
-    return this->eval_index_ref(this->evaluate(ex->lhs), this->evaluate(ex->rhs));
+    auto array = this->evaluate(ex->lhs);
+    auto index = this->evaluate(ex->rhs);
+
+    // reference to the row
+    if (array->is_vector() && array->As<ObjIterable>()->is_columnar()) {
+      auto vec = array->As<ObjIterable>();
+
+      if (index->get_vi() < 0 || index->get_vi() >= (i64)vec->Count())
+        throw Error(ex->rhs, "index out of range");
+
+      return vec->At((size_t)index->get_vi());
+    }
+
+    return this->eval_index_ref(ex, array, index);
   }
 
   case Kind::LambdaFunc: {
@@ -122,10 +230,14 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
 
     auto obj = ObjNew<ObjCallable>(func);
 
-    obj->type.params = {this->evaluate(func->return_type)->type};
+    TypeInfo type = TypeKind::Function;
+
+    type.params = {this->evaluate(func->return_type)->type};
 
     for (auto&& arg : func->arguments)
-      obj->type.params.emplace_back(this->evaluate(arg->type)->type);
+      type.params.emplace_back(this->evaluate(arg->type)->type);
+
+    obj->type = type;
 
     return obj;
   }
@@ -137,8 +249,7 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
     auto id = ast->GetID();
     auto obj = ObjNew<ObjCallable>(id->candidates[0]);
 
-    obj->type.params = id->ft_args;
-    obj->type.params.insert(obj->type.params.begin(), id->ft_ret);
+    obj->type = id->get_ft_type();
 
     return obj;
   }
@@ -147,8 +258,7 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
     auto id = ast->GetID();
     auto obj = ObjNew<ObjCallable>(id->candidates_builtin[0]);
 
-    obj->type.params = id->ft_args;
-    obj->type.params.insert(obj->type.params.begin(), id->ft_ret);
+    obj->type = id->get_ft_type();
 
     return obj;
   }
@@ -168,11 +278,15 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
   case Kind::MemberVariable: {
     auto ex = ast->as_expr();
 
-    auto inst = PtrCast<ObjInstance>(this->evaluate(ex->lhs));
+    i64 row;
+    auto obj = this->eval_member_owner(ex->lhs, row);
 
     auto id = ASTCast<AST::Identifier>(ex->rhs);
 
-    return inst->get_mvar(id->index);
+    if (row >= 0)
+      return obj->As<ObjIterable>()->columns->Get((size_t)row, id->index);
+
+    return obj->As<ObjInstance>()->get_mvar(id->index);
   }
 
   case Kind::MemberFunction: {
@@ -223,43 +337,27 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
       return _builtin->Call(x, std::move(args));
     }
 
-    auto stack = this->push_stack(x->args.size());
-
-    if (this->var_stack.size() >= 1588) {
-      throw Error(ast->token, "stack overflow");
-    }
-
-    this->call_stack.push_front(stack);
-
-    stack->var_list = std::move(args);
-
-    this->evaluate(_func->block);
-
-    auto result = stack->func_result;
-
-    this->pop_stack();
-    this->call_stack.pop_front();
-
-    return result ? result : _None;
+    return this->call_function(_func, std::move(args), ast);
   }
 
+  case Kind::Await:
+    return this->await(PtrCast<ObjFuture>(this->evaluate(ast->as_expr()->lhs)), ast);
+
   case Kind::CallFunc_Ctor: {
     CAST(CallFunc);
 
     auto ast_class = x->get_class_ptr();
 
-    auto inst = ObjNew<ObjInstance>(ast_class);
+    auto inst = ObjInstance::New(ast_class);
 
     size_t const argc = x->args.size();
 
-    inst->member_variables.resize(argc);
-
     for (size_t i = 0; i < argc; i++) {
       if (auto init = ast_class->member_variables[i]->init; init) {
-        inst->member_variables[i] = this->evaluate(init);
+        inst->set_mvar(i, this->evaluate(init));
       }
 
-      inst->member_variables[i] = this->evaluate(x->args[i]);
+      inst->set_mvar(i, this->evaluate(x->args[i]));
     }
 
     return inst;
@@ -289,10 +387,52 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
   case Kind::Assign: {
     auto x = ast->as_expr();
 
+    // raw value fields have no ObjPointer to refer
+    if (x->lhs->kind == Kind::MemberVariable) {
+      auto value = this->evaluate(x->rhs);
+
+      i64 row;
+      auto obj = this->eval_member_owner(x->lhs->as_expr()->lhs, row);
+
+      if (row >= 0)
+        obj->As<ObjIterable>()->columns->Set((size_t)row, x->lhs->GetID()->index, value);
+      else
+        obj->As<ObjInstance>()->set_mvar(x->lhs->GetID()->index, value);
+
+      return value;
+    }
+
+    // copy fields into the row of columnar vector
+    if (x->lhs->kind == Kind::IndexRef) {
+      auto ex = ASTCast<AST::Expr>(x->lhs);
+
+      auto value = this->evaluate(x->rhs);
+      auto obj = this->evaluate(ex->lhs);
+      auto index = this->evaluate(ex->rhs);
+
+      if (obj->is_vector() && obj->As<ObjIterable>()->is_columnar()) {
+        auto vec = obj->As<ObjIterable>();
+
+        if (index->get_vi() < 0 || index->get_vi() >= (i64)vec->Count())
+          throw Error(ex->rhs, "index out of range");
+
+        vec->columns->SetRow((size_t)index->get_vi(), PtrCast<ObjInstance>(value));
+
+        return value;
+      }
+
+      // insert new element to dict if not found
+      if (obj->is_dict())
+        return obj->As<ObjDict>()->Get(index) = value;
+
+      return this->eval_index_ref(ex, obj, index) = value;
+    }
+
     return this->eval_as_left(x->lhs) = this->evaluate(x->rhs);
   }
 
   case Kind::Return:
+  case Kind::Yield:
   case Kind::Throw:
   case Kind::Break:
   case Kind::Continue:
@@ -301,6 +441,8 @@ ObjPointer Evaluator::evaluate(ASTPointer ast) {
   case Kind::If:
   case Kind::Match:
   case Kind::While:
+  case Kind::ForEach:
+  case Kind::ParallelFor:
   case Kind::TryCatch:
   case Kind::Vardef:
     this->eval_stmt(ast);
@@ -0,0 +1,261 @@
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <thread>
+
+#include "EventLoop.h"
+#include "Object.h"
+
+namespace fire::io {
+
+//
+// threads for blocking I/O. (shared by all loops)
+//
+struct WorkerPool {
+  struct Job {
+    EventLoop::Callback work;
+    EventLoop::Callback done;
+    EventLoop* loop;
+  };
+
+  std::mutex mtx;
+  std::condition_variable cv;
+
+  std::deque<Job> jobs;
+  vector<std::thread> threads;
+
+  bool stop = false;
+
+  void push(Job job) {
+    {
+      std::lock_guard lock(this->mtx);
+
+      if (this->threads.empty()) {
+        auto count = std::max(4u, std::thread::hardware_concurrency());
+
+        for (u32 i = 0; i < count; i++)
+          this->threads.emplace_back([this] { this->run(); });
+      }
+
+      this->jobs.emplace_back(std::move(job));
+    }
+
+    this->cv.notify_one();
+  }
+
+  void run() {
+    while (true) {
+      Job job;
+
+      {
+        std::unique_lock lock(this->mtx);
+
+        this->cv.wait(lock, [this] { return this->stop || !this->jobs.empty(); });
+
+        if (this->jobs.empty())
+          return;
+
+        job = std::move(this->jobs.front());
+        this->jobs.pop_front();
+      }
+
+      job.work();
+      job.work = nullptr;
+
+      job.loop->complete(std::move(job.done));
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard lock(this->mtx);
+      this->stop = true;
+    }
+
+    this->cv.notify_all();
+
+    for (auto&& t : this->threads)
+      t.join();
+  }
+};
+
+static WorkerPool g_workers;
+
+EventLoop::EventLoop() {
+  this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  this->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+  epoll_event ev{};
+
+  ev.events = EPOLLIN;
+  ev.data.fd = this->event_fd;
+
+  epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, this->event_fd, &ev);
+}
+
+EventLoop::~EventLoop() {
+  // workers refer to this loop.
+  while (this->running_jobs > 0)
+    this->wait_events(-1);
+
+  close(this->event_fd);
+  close(this->epoll_fd);
+}
+
+void EventLoop::post(Callback cb) {
+  this->ready.emplace_back(std::move(cb));
+}
+
+void EventLoop::add_timer(i64 ms, Callback cb) {
+  this->timers.emplace(Clock::now() + std::chrono::milliseconds(ms), std::move(cb));
+}
+
+void EventLoop::watch(int fd, u32 events, Callback cb) {
+  epoll_event ev{};
+
+  ev.events = events;
+  ev.data.fd = fd;
+
+  epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+
+  this->watchers[fd] = std::move(cb);
+}
+
+void EventLoop::unwatch(int fd) {
+  epoll_ctl(this->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+
+  this->watchers.erase(fd);
+}
+
+void EventLoop::run_in_worker(Callback work, Callback done) {
+  this->running_jobs++;
+
+  g_workers.push({std::move(work), std::move(done), this});
+}
+
+void EventLoop::complete(Callback done) {
+  {
+    std::lock_guard lock(this->mtx);
+    this->completed.emplace_back(std::move(done));
+  }
+
+  u64 one = 1;
+  [[maybe_unused]] auto _ = write(this->event_fd, &one, sizeof(one));
+}
+
+void EventLoop::wait_events(int timeout_ms) {
+  epoll_event events[64];
+
+  int count = epoll_wait(this->epoll_fd, events, 64, timeout_ms);
+
+  for (int i = 0; i < count; i++) {
+    int fd = events[i].data.fd;
+
+    if (fd == this->event_fd) {
+      u64 n;
+      [[maybe_unused]] auto _ = read(this->event_fd, &n, sizeof(n));
+
+      std::lock_guard lock(this->mtx);
+
+      for (auto&& done : this->completed)
+        this->ready.emplace_back(std::move(done));
+
+      this->running_jobs -= this->completed.size();
+      this->completed.clear();
+    }
+    else if (auto it = this->watchers.find(fd); it != this->watchers.end()) {
+      // callback may unwatch fd
+      auto cb = it->second;
+      cb();
+    }
+  }
+
+  auto now = Clock::now();
+
+  while (!this->timers.empty() && this->timers.begin()->first <= now) {
+    this->ready.emplace_back(std::move(this->timers.begin()->second));
+    this->timers.erase(this->timers.begin());
+  }
+}
+
+bool EventLoop::run_once() {
+  if (!this->ready.empty()) {
+    auto list = std::move(this->ready);
+
+    this->ready.clear();
+
+    for (auto&& cb : list)
+      cb();
+
+    return true;
+  }
+
+  if (this->timers.empty() && this->watchers.empty() && this->running_jobs == 0)
+    return false;
+
+  int timeout = -1;
+
+  if (!this->timers.empty()) {
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(this->timers.begin()->first -
+                                                          Clock::now());
+
+    timeout = (int)std::max<i64>(ms.count(), 0);
+  }
+
+  this->wait_events(timeout);
+
+  return true;
+}
+
+void EventLoop::cancel_all() {
+  while (this->running_jobs > 0)
+    this->wait_events(-1);
+
+  for (auto&& [fd, cb] : this->watchers) {
+    epoll_ctl(this->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+  }
+
+  // callbacks may hold other callbacks. (ex: waiters of FutureState)
+  auto ready = std::move(this->ready);
+  auto timers = std::move(this->timers);
+  auto watchers = std::move(this->watchers);
+
+  this->ready.clear();
+  this->timers.clear();
+  this->watchers.clear();
+}
+
+EventLoop& EventLoop::get() {
+  static thread_local EventLoop loop;
+
+  return loop;
+}
+
+void FutureState::resolve(ObjPointer obj) {
+  this->done = true;
+  this->result = std::move(obj);
+
+  auto& loop = EventLoop::get();
+
+  for (auto&& w : this->waiters)
+    loop.post(std::move(w));
+
+  this->waiters.clear();
+}
+
+void FutureState::reject(std::exception_ptr e) {
+  this->done = true;
+  this->error = std::move(e);
+
+  auto& loop = EventLoop::get();
+
+  for (auto&& w : this->waiters)
+    loop.post(std::move(w));
+
+  this->waiters.clear();
+}
+
+} // namespace fire::io
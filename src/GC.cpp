@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "GC.h"
+#include "Object.h"
+
+namespace fire::gc {
+
+static Config g_config;
+
+// each thread has own objects. (see detach / adopt)
+static thread_local Stats g_stats;
+
+// tracked objects. (removed by untrack() in destructor)
+static thread_local vector<Object*> g_objects;
+
+thread_local size_t allocated_since_collect = 0;
+thread_local size_t next_collect = 0; // first safepoint sets threshold
+
+Config& get_config() {
+  return g_config;
+}
+
+Stats const& get_stats() {
+  return g_stats;
+}
+
+void set_threshold(size_t threshold) {
+  g_config.threshold = threshold;
+  next_collect = threshold;
+}
+
+void track(Object* obj) {
+  obj->is_tracked = true;
+  obj->gc_index = g_objects.size();
+
+  g_objects.emplace_back(obj);
+
+  g_stats.allocated++;
+  allocated_since_collect++;
+}
+
+void untrack(Object* obj) {
+  auto last = g_objects.back();
+
+  g_objects[obj->gc_index] = last;
+  last->gc_index = obj->gc_index;
+
+  g_objects.pop_back();
+
+  obj->is_tracked = false;
+}
+
+size_t collect() {
+  auto begin = std::chrono::steady_clock::now();
+
+  allocated_since_collect = 0;
+
+  if (g_objects.empty()) {
+    next_collect = g_config.threshold;
+    return 0;
+  }
+
+  if (!g_config.enabled) {
+    next_collect = std::max(g_config.threshold, g_objects.size());
+    return 0;
+  }
+
+  vector<Object*> refs;
+
+  for (auto&& obj : g_objects) {
+    obj->gc_refs = obj->ref_count;
+    obj->is_marked = false;
+  }
+
+  // subtract references from tracked objects
+  for (auto&& obj : g_objects) {
+    refs.clear();
+    obj->Trace(refs);
+
+    for (auto&& r : refs)
+      if (r->is_tracked)
+        r->gc_refs--;
+  }
+
+  // mark all reachable from referenced by others
+  vector<Object*> work;
+
+  for (auto&& obj : g_objects) {
+    if (obj->gc_refs > 0 && !obj->is_marked) {
+      obj->is_marked = true;
+      work.emplace_back(obj);
+    }
+  }
+
+  while (!work.empty()) {
+    auto obj = work.back();
+    work.pop_back();
+
+    refs.clear();
+    obj->Trace(refs);
+
+    for (auto&& r : refs) {
+      if (r->is_tracked && !r->is_marked) {
+        r->is_marked = true;
+        work.emplace_back(r);
+      }
+    }
+  }
+
+  // not marked = referenced only by unreachable cycles
+  ObjVector garbage;
+
+  for (auto&& obj : g_objects)
+    if (!obj->is_marked)
+      garbage.emplace_back(obj);
+
+  for (auto&& g : garbage)
+    g->ClearRefs();
+
+  size_t freed = garbage.size();
+
+  g_stats.traced += g_objects.size();
+
+  // freed objects are removed from g_objects here
+  garbage.clear();
+
+  g_stats.collections++;
+  g_stats.freed += freed;
+  g_stats.live = g_objects.size();
+  g_stats.max_live = std::max(g_stats.max_live, g_stats.live);
+
+  next_collect = std::max(g_config.threshold, g_stats.live);
+
+  g_stats.time_ms += std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
+
+  return freed;
+}
+
+void detach(Object* obj) {
+  if (!obj || !obj->is_tracked)
+    return;
+
+  vector<Object*> work = {obj};
+  vector<Object*> refs;
+
+  untrack(obj);
+  obj->is_detached = true;
+
+  while (!work.empty()) {
+    auto x = work.back();
+    work.pop_back();
+
+    refs.clear();
+    x->Trace(refs);
+
+    for (auto&& r : refs) {
+      if (r->is_tracked) {
+        untrack(r);
+        r->is_detached = true;
+        work.emplace_back(r);
+      }
+    }
+  }
+}
+
+void adopt(Object* obj) {
+  if (!obj || !obj->is_detached)
+    return;
+
+  vector<Object*> work = {obj};
+  vector<Object*> refs;
+
+  obj->is_detached = false;
+  track(obj);
+
+  while (!work.empty()) {
+    auto x = work.back();
+    work.pop_back();
+
+    refs.clear();
+    x->Trace(refs);
+
+    for (auto&& r : refs) {
+      if (r->is_detached) {
+        r->is_detached = false;
+        track(r);
+        work.emplace_back(r);
+      }
+    }
+  }
+}
+
+void release_thread() {
+  for (auto&& obj : g_objects)
+    obj->is_tracked = false;
+
+  g_objects.clear();
+}
+
+static thread_local vector<Object*> g_deferred;
+
+void defer_delete(Object* obj) {
+  g_deferred.emplace_back(obj);
+}
+
+// objects in Columns are not traced. (see ObjIterable::Trace)
+static void trace_columns(Columns const& cols, vector<Object*>& out) {
+  for (auto&& col : cols.columns)
+    for (auto&& e : col.boxed)
+      if (e)
+        out.emplace_back(e.get());
+}
+
+void freeze(Object* obj, vector<Object*>& frozen) {
+  if (!obj || obj->is_frozen)
+    return;
+
+  vector<Object*> work = {obj};
+  vector<Object*> refs;
+
+  obj->is_frozen = true;
+  frozen.emplace_back(obj);
+
+  while (!work.empty()) {
+    auto x = work.back();
+    work.pop_back();
+
+    refs.clear();
+    x->Trace(refs);
+
+    // (ObjRowRef traces its vector)
+    if (x->is_vector() && x->As<ObjIterable>()->is_columnar())
+      trace_columns(*x->As<ObjIterable>()->columns, refs);
+
+    for (auto&& r : refs) {
+      if (!r->is_frozen) {
+        r->is_frozen = true;
+        frozen.emplace_back(r);
+        work.emplace_back(r);
+      }
+    }
+  }
+}
+
+void unfreeze(vector<Object*>& frozen, vector<Object*>& deferred) {
+  for (auto&& obj : frozen)
+    obj->is_frozen = false;
+
+  frozen.clear();
+
+  // an object is pushed each time its count drops to zero, and it may be
+  // referred again after that. so delete only ones still unreferenced.
+  // (candidates are chosen before deleting: children released by delete
+  //  are not frozen now, and deleted by ObjRef itself)
+  std::sort(deferred.begin(), deferred.end());
+  deferred.erase(std::unique(deferred.begin(), deferred.end()), deferred.end());
+
+  std::erase_if(deferred, [](Object* obj) { return obj->ref_count != 0; });
+
+  for (auto&& obj : deferred)
+    delete obj;
+
+  deferred.clear();
+}
+
+vector<Object*> take_deferred() {
+  return std::move(g_deferred);
+}
+
+vector<Object*> detach_thread() {
+  for (auto&& obj : g_objects) {
+    obj->is_tracked = false;
+    obj->is_detached = true;
+  }
+
+  return std::move(g_objects);
+}
+
+void print_stats() {
+  std::cerr << "gc: collections = " << g_stats.collections << std::endl
+            << "gc: allocated   = " << g_stats.allocated << std::endl
+            << "gc: traced      = " << g_stats.traced << std::endl
+            << "gc: freed       = " << g_stats.freed << std::endl
+            << "gc: live        = " << g_stats.live << " (max " << g_stats.max_live
+            << ")" << std::endl
+            << "gc: time        = " << g_stats.time_ms << " ms" << std::endl;
+}
+
+} // namespace fire::gc
@@ -1,3 +1,10 @@
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "alert.h"
 
 #include "Lexer.h"
@@ -6,13 +13,258 @@
 
 namespace fire {
 
-static char const* punctuaters[] = {
-    "...", "<<=", ">>=", "<<", ">>", "=>", "<=", ">=", "==", "!=", "..", "+=",
-    "-=",  "*=",  "/=",  "%=", "&=", "^=", "|=", "&&", "||", "->", "::", "<",
-    ">",   "+",   "-",   "/",  "*",  "%",  "=",  ";",  ":",  ",",  ".",  "[",
-    "]",   "(",   ")",   "{",  "}",  "!",  "?",  "&",  "^",  "|",  "@",
+//
+// character classes
+//
+//  first byte of token selects the way to scan it.
+//
+enum CharClass : u8 {
+  CC_Other,
+  CC_Space,
+  CC_Digit,
+  CC_Ident, // alphabet or '_'
+  CC_Quote,
+  CC_Punct,
+};
+
+static constexpr auto char_classes = [] {
+  std::array<u8, 256> table{};
+
+  for (int c = 0; c < 256; c++) {
+    if (c == ' ' || ('\t' <= c && c <= '\r'))
+      table[c] = CC_Space;
+    else if ('0' <= c && c <= '9')
+      table[c] = CC_Digit;
+    else if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_')
+      table[c] = CC_Ident;
+    else if (c == '\'' || c == '"')
+      table[c] = CC_Quote;
+  }
+
+  for (char c : std::string_view("!%&()*+,-./:;<=>?@[]^{|}"))
+    table[(u8)c] = CC_Punct;
+
+  return table;
+}();
+
+//
+// scanners of runs of characters. (16 bytes at once with SSE2)
+//
+//  each has test() for one byte, and mask() which returns bits of bytes
+//  matched in 16 bytes. bytes >= 0x80 are negative for signed compare,
+//  so they never match.
+//
+#if defined(__SSE2__)
+static inline __m128i in_range(__m128i v, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)(lo - 1))),
+                       _mm_cmplt_epi8(v, _mm_set1_epi8((char)(hi + 1))));
+}
+#endif
+
+struct SpaceChars {
+  static bool test(u8 c) {
+    return char_classes[c] == CC_Space;
+  }
+
+#if defined(__SSE2__)
+  static u32 mask(__m128i v) {
+    return (u32)_mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), in_range(v, '\t', '\r')));
+  }
+#endif
+};
+
+struct DigitChars {
+  static bool test(u8 c) {
+    return char_classes[c] == CC_Digit;
+  }
+
+#if defined(__SSE2__)
+  static u32 mask(__m128i v) {
+    return (u32)_mm_movemask_epi8(in_range(v, '0', '9'));
+  }
+#endif
 };
 
+struct IdentChars {
+  static bool test(u8 c) {
+    return char_classes[c] == CC_Ident || char_classes[c] == CC_Digit;
+  }
+
+#if defined(__SSE2__)
+  static u32 mask(__m128i v) {
+    // (c | 0x20) is in 'a' .. 'z' only if c is alphabet
+    auto alpha = in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+
+    return (u32)_mm_movemask_epi8(_mm_or_si128(
+        _mm_or_si128(alpha, in_range(v, '0', '9')), _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))));
+  }
+#endif
+};
+
+// skip characters of Chars from p, returns first other character.
+template <class Chars>
+static char const* skip(char const* p, char const* end) {
+#if defined(__SSE2__)
+  while (end - p >= 16) {
+    u32 m = ~Chars::mask(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))) & 0xFFFF;
+
+    if (m)
+      return p + __builtin_ctz(m);
+
+    p += 16;
+  }
+#endif
+
+  while (p < end && Chars::test((u8)*p))
+    p++;
+
+  return p;
+}
+
+//
+// length of longest punctuater at s, or 0 if not punctuater.
+//
+//  ...  <<=  >>=  <<  >>  =>  <=  >=  ==  !=  ..  +=  -=  *=  /=  %=
+//  &=  ^=  |=  &&  ||  ->  ::  and single characters in CC_Punct.
+//
+//  source ends with '\0', so s[1] is always readable, and s[2] is read
+//  only if s[1] is not '\0'.
+//
+static i64 punct_length(char const* s) {
+  switch (s[0]) {
+  case '.':
+    if (s[1] == '.')
+      return s[2] == '.' ? 3 : 2;
+
+    return 1;
+
+  case '<':
+  case '>':
+    if (s[1] == s[0])
+      return s[2] == '=' ? 3 : 2;
+
+    return s[1] == '=' ? 2 : 1;
+
+  case '=':
+    return s[1] == '=' || s[1] == '>' ? 2 : 1;
+
+  case '-':
+    return s[1] == '=' || s[1] == '>' ? 2 : 1;
+
+  case '&':
+  case '|':
+    return s[1] == '=' || s[1] == s[0] ? 2 : 1;
+
+  case ':':
+    return s[1] == ':' ? 2 : 1;
+
+  case '!':
+  case '+':
+  case '*':
+  case '/':
+  case '%':
+  case '^':
+    return s[1] == '=' ? 2 : 1;
+
+  case ';':
+  case ',':
+  case '[':
+  case ']':
+  case '(':
+  case ')':
+  case '{':
+  case '}':
+  case '?':
+  case '@':
+    return 1;
+  }
+
+  return 0;
+}
+
+//
+// keywords
+//
+//  looked up by perfect hash of first two bytes, last byte and length.
+//  (no collision for the words below, checked by static_assert)
+//
+struct KeywordEntry {
+  std::string_view str;
+  Keyword kw = Keyword::None;
+};
+
+static constexpr KeywordEntry keywords[] = {
+    {"async", Keyword::Async},
+    {"await", Keyword::Await},
+    {"break", Keyword::Break},
+    {"catch", Keyword::Catch},
+    {"class", Keyword::Class},
+    {"continue", Keyword::Continue},
+    {"else", Keyword::Else},
+    {"enum", Keyword::Enum},
+    {"false", Keyword::False},
+    {"fn", Keyword::Fn},
+    {"for", Keyword::For},
+    {"if", Keyword::If},
+    {"in", Keyword::In},
+    {"include", Keyword::Include},
+    {"into", Keyword::Into},
+    {"lambda", Keyword::Lambda},
+    {"let", Keyword::Let},
+    {"match", Keyword::Match},
+    {"namespace", Keyword::Namespace},
+    {"of", Keyword::Of},
+    {"parallel", Keyword::Parallel},
+    {"reduce", Keyword::Reduce},
+    {"return", Keyword::Return},
+    {"self", Keyword::Self},
+    {"throw", Keyword::Throw},
+    {"true", Keyword::True},
+    {"try", Keyword::Try},
+    {"while", Keyword::While},
+    {"yield", Keyword::Yield},
+};
+
+static constexpr size_t KeywordMinLen = 2;
+static constexpr size_t KeywordMaxLen = 9;
+
+static constexpr size_t keyword_hash(std::string_view s) {
+  return ((u8)s[0] * 33 + (u8)s[1] * 11 + (u8)s.back() + s.length()) & 63;
+}
+
+static constexpr auto keyword_table = [] {
+  std::array<KeywordEntry, 64> table{};
+
+  for (auto&& e : keywords)
+    table[keyword_hash(e.str)] = e;
+
+  return table;
+}();
+
+static constexpr bool is_perfect_hash() {
+  for (auto&& e : keywords) {
+    if (keyword_table[keyword_hash(e.str)].kw != e.kw)
+      return false;
+
+    if (e.str.length() < KeywordMinLen || e.str.length() > KeywordMaxLen)
+      return false;
+  }
+
+  return true;
+}
+
+static_assert(is_perfect_hash(), "hash of keywords is collided");
+
+static Keyword find_keyword(std::string_view s) {
+  if (s.length() < KeywordMinLen || s.length() > KeywordMaxLen)
+    return Keyword::None;
+
+  auto const& e = keyword_table[keyword_hash(s)];
+
+  return e.str == s ? e.kw : Keyword::None;
+}
+
 Lexer::Lexer(SourceStorage& source)
     : source(source),
       position(0),
@@ -21,112 +273,120 @@ Lexer::Lexer(SourceStorage& source)
 }
 
 bool Lexer::Lex(Vec<Token>& out) {
+  auto const begin = this->source.data.data();
+  auto const end = begin + this->length;
+
   this->pass_space();
 
   while (this->check()) {
-    auto c = this->peek();
-    auto s = this->source.data.data() + this->position;
+    auto s = begin + this->position;
     auto pos = this->position;
+    char c = *s;
 
-    // comment line
-    if (this->eat("//")) {
-      while (this->check() && !this->eat('\n'))
-        this->position++;
+    if (c == '/') {
+      // comment line
+      if (s[1] == '/') {
+        auto p = (char const*)std::memchr(s + 2, '\n', end - s - 2);
 
-      this->pass_space();
-      continue;
-    }
+        this->position = p ? p - begin + 1 : this->length;
+        this->pass_space();
+        continue;
+      }
 
-    // comment block
-    if (this->eat("/*")) {
-      while (this->check() && !this->eat("*/"))
-        this->position++;
+      // comment block
+      if (s[1] == '*') {
+        auto p = this->src_view.find("*/", this->position + 2);
 
-      this->pass_space();
-      continue;
+        this->position = p == std::string_view::npos ? this->length : (i64)p + 2;
+        this->pass_space();
+        continue;
+      }
     }
 
-    Token& tok = out.emplace_back(
-        Token(TokenKind::Unknown, " ", SourceLocation(pos, 1, &this->source)));
+    Token& tok = out.emplace_back(TokenKind::Unknown, "", SourceLocation(pos, 1, &this->source));
 
-    // hex
-    if (this->eat("0x") || this->eat("0X")) {
-      tok.kind = TokenKind::Hex;
+    tok._index = (u32)(out.size() - 1);
 
-      while (isxdigit(this->peek()))
-        this->position++;
-    }
+    switch (char_classes[(u8)c]) {
+    case CC_Digit:
+      // hex
+      if (c == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        tok.kind = TokenKind::Hex;
+        this->position += 2;
 
-    // bin
-    else if (this->eat("0b") || this->eat("0B")) {
-      tok.kind = TokenKind::Bin;
+        while (isxdigit(this->peek()))
+          this->position++;
+      }
 
-      while (this->peek() == '0' || this->peek() == '1')
-        this->position++;
-    }
+      // bin
+      else if (c == '0' && (s[1] == 'b' || s[1] == 'B')) {
+        tok.kind = TokenKind::Bin;
+        this->position += 2;
 
-    // digits
-    else if (isdigit(c)) {
-      tok.kind = TokenKind::Int;
+        while (this->peek() == '0' || this->peek() == '1')
+          this->position++;
+      }
 
-      while (isdigit(this->peek()))
-        this->position++;
+      // digits
+      else {
+        tok.kind = TokenKind::Int;
+        this->position = skip<DigitChars>(s, end) - begin;
 
-      // float
-      if (this->eat(".")) {
-        tok.kind = TokenKind::Float;
+        // float ("1..n" is range)
+        if (this->peek() == '.' && this->source[this->position + 1] != '.') {
+          tok.kind = TokenKind::Float;
+          this->position = skip<DigitChars>(begin + this->position + 1, end) - begin;
+        }
 
-        while (isdigit(this->peek()))
-          this->position++;
+        if (this->eat('f'))
+          tok.kind = TokenKind::Float;
       }
 
-      if (this->eat("f"))
-        tok.kind = TokenKind::Float;
-    }
+      break;
 
     // identifier or keyword
-    else if (isalpha(c) || c == '_') {
+    case CC_Ident:
       tok.kind = TokenKind::Identifier;
+      this->position = skip<IdentChars>(s, end) - begin;
 
-      while (isalnum(this->peek()) || this->peek() == '_')
-        this->position++;
-    }
+      tok.keyword = find_keyword(this->trim(pos, this->position - pos));
+
+      if (tok.keyword == Keyword::True || tok.keyword == Keyword::False)
+        tok.kind = TokenKind::Boolean;
+
+      break;
 
     // char or string literal
-    else if (this->eat('\'') || this->eat('"')) {
-      char quat = c;
-      bool is_str = quat == '"';
+    case CC_Quote: {
+      bool is_str = c == '"';
 
       tok.kind = is_str ? TokenKind::String : TokenKind::Char;
 
-      while (this->check() && (c = this->peek()) != quat)
-        this->position++;
+      auto p = (char const*)std::memchr(s + 1, c, end - s - 1);
 
-      if (!this->check() || !this->eat(quat)) {
+      if (!p) {
         throw Error(tok).format("not terminated %s literal",
                                 is_str ? "string" : "character");
       }
+
+      this->position = p - begin + 1;
+      break;
     }
 
-    else {
-      for (std::string_view s : punctuaters) {
-        if (this->match(s)) {
-          tok.kind = TokenKind::Punctuater;
-          tok.str = s;
-          this->position += s.length();
-          goto found_punct;
-        }
+    case CC_Punct:
+      if (auto len = punct_length(s); len != 0) {
+        tok.kind = TokenKind::Punctuater;
+        this->position += len;
+        break;
       }
 
-      Error(tok, "invalid token")();
-    }
-
-    tok.str = std::string_view(s, this->position - pos);
+      [[fallthrough]];
 
-    if (tok.str == "true" || tok.str == "false")
-      tok.kind = TokenKind::Boolean;
+    default:
+      throw Error(tok, "invalid token");
+    }
 
-  found_punct:
+    tok.str = this->trim(pos, this->position - pos);
 
     // tok.sourceloc = SourceLocation(pos, tok.str.length(), &this->source);
     tok.sourceloc.length = this->position - pos;
@@ -146,16 +406,9 @@ char Lexer::peek() {
 }
 
 void Lexer::pass_space() {
-  while (isspace(this->peek()))
-    this->position++;
-}
-
-bool Lexer::match(std::string_view str) {
-
-  i64 const len = static_cast<i64>(str.length());
+  auto const begin = this->source.data.data();
 
-  return this->position + len <= this->length &&
-         this->src_view.substr(this->position, len) == str;
+  this->position = skip<SpaceChars>(begin + this->position, begin + this->length) - begin;
 }
 
 } // namespace fire
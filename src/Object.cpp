@@ -1,15 +1,68 @@
 #include <cassert>
+#include <unordered_map>
 
 #include "alert.h"
 #include "Utils.h"
 #include "Builtin.h"
 #include "AST.h"
+#include "GC.h"
 
 using namespace std::string_literals;
 
 namespace fire {
 
-Object::Object(TypeInfo type)
+// ----------------------------
+//  CloneMemo
+
+static thread_local std::unordered_map<Object const*, ObjPointer>* g_clone_memo;
+static thread_local int g_clone_memo_depth;
+
+CloneMemo::CloneMemo() {
+  if (g_clone_memo_depth++ == 0)
+    g_clone_memo = new std::unordered_map<Object const*, ObjPointer>();
+}
+
+CloneMemo::~CloneMemo() {
+  if (--g_clone_memo_depth == 0) {
+    delete g_clone_memo;
+    g_clone_memo = nullptr;
+  }
+}
+
+ObjPointer CloneMemo::Find(Object const* obj) {
+  if (!g_clone_memo)
+    return nullptr;
+
+  if (auto it = g_clone_memo->find(obj); it != g_clone_memo->end())
+    return it->second;
+
+  return nullptr;
+}
+
+void CloneMemo::Add(Object const* obj, ObjPointer const& copy) {
+  if (g_clone_memo)
+    g_clone_memo->emplace(obj, copy);
+}
+
+static ObjPointer box_raw_value(TypeKind kind, void const* p) {
+  switch (kind) {
+  case TypeKind::Int:
+    return ObjNew<ObjPrimitive>(*static_cast<i64 const*>(p));
+
+  case TypeKind::Float:
+    return ObjNew<ObjPrimitive>(*static_cast<double const*>(p));
+
+  case TypeKind::Bool:
+    return ObjNew<ObjPrimitive>(*static_cast<bool const*>(p));
+
+  case TypeKind::Char:
+    return ObjNew<ObjPrimitive>(*static_cast<char16_t const*>(p));
+  }
+
+  panic;
+}
+
+Object::Object(TypeId type)
     : type(std::move(type)),
       is_marked(false) {
 }
@@ -65,9 +118,87 @@ std::string ObjPrimitive::ToString() const {
   todo_impl;
 }
 
+size_t ObjPrimitive::Hash() const {
+  switch (this->type.kind) {
+  case TypeKind::Bool:
+    return this->vb;
+
+  case TypeKind::Char:
+    return this->vc;
+  }
+
+  return static_cast<size_t>(this->vi);
+}
+
+// elements are copied. (columnar: fields of a clone go into the row)
+void ObjIterable::AppendList(ObjPtr<ObjIterable> obj) {
+  for (size_t i = 0, n = obj->Count(); i < n; i++) {
+    if (this->columns)
+      this->columns->Append(PtrCast<ObjInstance>(obj->At(i)->Clone()));
+    else
+      this->Append(obj->At(i)->Clone());
+  }
+}
+
+ObjPointer ObjIterable::At(size_t index) const {
+  if (this->columns)
+    return ObjNew<ObjRowRef>(ObjPtr<ObjIterable>(const_cast<ObjIterable*>(this)), index);
+
+  return this->list[index];
+}
+
+bool ObjIterable::ToColumns() {
+  if (this->columns)
+    return true;
+
+  if (this->type->params.empty() || this->type->params[0].kind != TypeKind::Instance)
+    return false;
+
+  auto cols = std::make_shared<Columns>(ASTCast<AST::Class>(this->type->params[0].type_ast));
+
+  for (size_t i = 0; i < cols->columns.size(); i++) {
+    if (cols->ast->layout[i].kind == TypeKind::None)
+      cols->columns[i].boxed.reserve(this->list.size());
+    else
+      cols->columns[i].raw.reserve(this->list.size());
+  }
+
+  for (auto&& e : this->list)
+    cols->Append(PtrCast<ObjInstance>(e));
+
+  this->list.clear();
+  this->list.shrink_to_fit();
+
+  this->columns = std::move(cols);
+
+  return true;
+}
+
+void ObjIterable::ToRows() {
+  if (!this->columns)
+    return;
+
+  this->list.reserve(this->columns->count);
+
+  for (size_t i = 0; i < this->columns->count; i++)
+    this->list.emplace_back(this->columns->GetRow(i));
+
+  this->columns = nullptr;
+}
+
 ObjPointer ObjIterable::Clone() const {
+  if (auto p = CloneMemo::Find(this); p)
+    return p;
+
   auto obj = ObjNew<ObjIterable>(this->type);
 
+  CloneMemo::Add(this, obj);
+
+  if (this->columns) {
+    obj->columns = this->columns->Clone();
+    return obj;
+  }
+
   for (auto&& x : this->list)
     obj->Append(x->Clone());
 
@@ -77,15 +208,95 @@ ObjPointer ObjIterable::Clone() const {
 std::string ObjIterable::ToString() const {
   std::string ret;
 
-  for (auto it = this->list.begin(); it != this->list.end(); it++) {
-    ret += (*it)->ToString();
-    if (it < this->list.end() - 1)
+  for (size_t i = 0, n = this->Count(); i < n; i++) {
+    if (i > 0)
       ret += ", ";
+
+    ret += this->At(i)->ToString();
   }
 
   return "[" + ret + "]";
 }
 
+// ----------------------------
+//  Columns
+
+ObjPointer Columns::Get(size_t row, size_t index) const {
+  auto kind = this->ast->layout[index].kind;
+
+  if (kind == TypeKind::None)
+    return this->columns[index].boxed[row];
+
+  return box_raw_value(kind, &this->columns[index].raw[row]);
+}
+
+void Columns::Set(size_t row, size_t index, ObjPointer obj) {
+  if (this->ast->layout[index].kind == TypeKind::None)
+    this->columns[index].boxed[row] = std::move(obj);
+  else
+    this->columns[index].raw[row] = obj->As<ObjPrimitive>()->_data;
+}
+
+void Columns::Append(ObjPtr<ObjInstance> inst) {
+  for (size_t i = 0; i < this->columns.size(); i++) {
+    if (this->ast->layout[i].kind == TypeKind::None)
+      this->columns[i].boxed.emplace_back();
+    else
+      this->columns[i].raw.emplace_back();
+  }
+
+  this->SetRow(this->count++, inst);
+}
+
+void Columns::SetRow(size_t row, ObjPtr<ObjInstance> inst) {
+  for (size_t i = 0; i < this->columns.size(); i++) {
+    auto const& f = this->ast->layout[i];
+
+    if (f.kind == TypeKind::None)
+      this->columns[i].boxed[row] = inst->get_mvar(i);
+    else if (inst->fields)
+      this->columns[i].raw[row] = *reinterpret_cast<u64*>(inst->fields + f.offset);
+    else
+      this->columns[i].raw[row] = inst->get_mvar(i)->As<ObjPrimitive>()->_data;
+  }
+}
+
+ObjPtr<ObjInstance> Columns::GetRow(size_t row) const {
+  auto inst = ObjInstance::New(this->ast);
+
+  for (size_t i = 0; i < this->columns.size(); i++) {
+    auto const& f = this->ast->layout[i];
+
+    if (f.kind == TypeKind::None)
+      *reinterpret_cast<ObjPointer*>(inst->fields + f.offset) =
+          this->columns[i].boxed[row];
+    else
+      *reinterpret_cast<u64*>(inst->fields + f.offset) = this->columns[i].raw[row];
+  }
+
+  return inst;
+}
+
+std::shared_ptr<Columns> Columns::Clone() const {
+  auto cols = std::make_shared<Columns>(this->ast);
+
+  cols->count = this->count;
+
+  for (size_t i = 0; i < this->columns.size(); i++) {
+    cols->columns[i].raw = this->columns[i].raw;
+
+    for (auto&& x : this->columns[i].boxed)
+      cols->columns[i].boxed.emplace_back(x->Clone());
+  }
+
+  return cols;
+}
+
+Columns::Columns(ASTPtr<AST::Class> ast)
+    : ast(ast),
+      columns(ast->member_variables.size()) {
+}
+
 // ----------------------------
 //  ObjString
 
@@ -119,6 +330,16 @@ ObjPointer ObjString::Clone() const {
   return obj;
 }
 
+size_t ObjString::Hash() const {
+  // FNV-1a
+  size_t h = 0xcbf29ce484222325ull;
+
+  for (auto&& c : this->list)
+    h = (h ^ c->As<ObjPrimitive>()->vc) * 0x100000001b3ull;
+
+  return h;
+}
+
 ObjString::ObjString(std::u16string const& str)
     : ObjIterable(TypeKind::String) {
   for (auto&& c : str)
@@ -159,44 +380,292 @@ std::string ObjEnumerator::ToString() const {
   return s;
 }
 
+size_t ObjEnumerator::Hash() const {
+  size_t h = hash_combine(reinterpret_cast<size_t>(this->ast), this->index);
+
+  if (!this->data)
+    return h;
+
+  // arguments of structure are kept in a vector
+  if (this->ast->enumerators[this->index].data_type ==
+      AST::Enum::Enumerator::DataType::Structure) {
+    for (auto&& x : this->data->As<ObjIterable>()->list)
+      h = hash_combine(h, x->Hash());
+
+    return h;
+  }
+
+  return hash_combine(h, this->data->Hash());
+}
+
 ObjEnumerator::ObjEnumerator(ASTPtr<AST::Enum> ast, int index)
-    : Object(TypeKind::Enumerator),
+    : Object(ast->enumerator_type),
       ast(ast),
       index(index) {
-  this->type.name = this->ast->GetName();
+}
+
+// ----------------------------
+//  ObjTuple
+
+ObjPointer ObjTuple::Clone() const {
+  if (auto p = CloneMemo::Find(this); p)
+    return p;
+
+  auto obj = ObjNew<ObjTuple>(this->type, this->count);
+
+  CloneMemo::Add(this, obj);
+
+  for (size_t i = 0; i < this->count; i++)
+    obj->Get(i) = this->Get(i)->Clone();
+
+  return obj;
+}
+
+std::string ObjTuple::ToString() const {
+  std::string ret;
+
+  for (size_t i = 0; i < this->count; i++) {
+    if (i > 0)
+      ret += ", ";
+
+    ret += this->Get(i)->ToStringAsMember();
+  }
+
+  return "(" + ret + ")";
+}
+
+bool ObjTuple::Equals(ObjPointer const& obj) const {
+  if (!obj->is_tuple() || obj->As<ObjTuple>()->count != this->count)
+    return false;
+
+  for (size_t i = 0; i < this->count; i++)
+    if (!this->Get(i)->Equals(obj->As<ObjTuple>()->Get(i)))
+      return false;
+
+  return true;
+}
+
+size_t ObjTuple::Hash() const {
+  size_t h = this->count;
+
+  for (size_t i = 0; i < this->count; i++)
+    h = hash_combine(h, this->Get(i)->Hash());
+
+  return h;
+}
+
+// ----------------------------
+//  ObjDict
+
+ObjVector ObjDict::Keys() const {
+  ObjVector keys;
+
+  keys.reserve(this->table.size());
+
+  for (auto&& [k, v] : this->table)
+    keys.emplace_back(k);
+
+  return keys;
+}
+
+ObjPointer ObjDict::Clone() const {
+  if (auto p = CloneMemo::Find(this); p)
+    return p;
+
+  auto obj = ObjNew<ObjDict>(this->type);
+
+  CloneMemo::Add(this, obj);
+
+  obj->table.reserve(this->table.size());
+
+  for (auto&& [k, v] : this->table)
+    obj->Insert(k->Clone(), v->Clone());
+
+  return obj;
+}
+
+std::string ObjDict::ToString() const {
+  std::string ret;
+
+  for (auto&& [k, v] : this->table) {
+    if (!ret.empty())
+      ret += ", ";
+
+    ret += k->ToStringAsMember() + ": " + v->ToStringAsMember();
+  }
+
+  return "{" + ret + "}";
+}
+
+bool ObjDict::Equals(ObjPointer const& obj) const {
+  if (!obj->is_dict())
+    return false;
+
+  auto x = obj->As<ObjDict>();
+
+  if (this->Count() != x->Count())
+    return false;
+
+  for (auto&& [k, v] : this->table) {
+    if (auto p = x->Find(k); !p || !v->Equals(*p))
+      return false;
+  }
+
+  return true;
 }
 
 // ----------------------------
 //  ObjInstance
 
+//
+// allocates the trailing bytes for member variables
+// together with the object.
+//
+ObjPtr<ObjInstance> ObjInstance::New(ASTPtr<AST::Class> ast) {
+  assert(ast->layout.size() == ast->member_variables.size());
+
+  // not tracked until fields are initialized. (see below)
+  auto obj = ::new (alloc::allocate(sizeof(ObjInstance) + ast->fields_size)) ObjInstance(ast);
+
+  // fields_size bytes right after the object are in the block too.
+  obj->fields = reinterpret_cast<u8*>(obj + 1);
+
+  for (auto&& f : ast->layout) {
+    if (f.kind == TypeKind::None)
+      new (obj->fields + f.offset) ObjPointer();
+    else
+      *reinterpret_cast<u64*>(obj->fields + f.offset) = 0;
+  }
+
+#if _DBG_DONT_USE_SMART_PTR_
+  return obj;
+#else
+  gc::track(obj);
+
+  return ObjPtr<ObjInstance>(obj);
+#endif
+}
+
+void ObjInstance::operator delete(ObjInstance* p, std::destroying_delete_t) {
+  size_t size = sizeof(ObjInstance) + p->ast->fields_size;
+
+  p->~ObjInstance();
+
+  alloc::deallocate(p, size);
+}
+
+ObjPointer ObjInstance::get_mvar(i64 index) const {
+  if (!this->fields) {
+    auto ref = static_cast<ObjRowRef const*>(this);
+
+    // vector is back to rows
+    if (!ref->vec->columns)
+      return ref->vec->list[ref->row]->As<ObjInstance>()->get_mvar(index);
+
+    return ref->vec->columns->Get(ref->row, index);
+  }
+
+  auto const& f = this->ast->layout[index];
+  auto p = this->fields + f.offset;
+
+  if (f.kind == TypeKind::None)
+    return *reinterpret_cast<ObjPointer*>(p);
+
+  return box_raw_value(f.kind, p);
+}
+
+void ObjInstance::set_mvar(i64 index, ObjPointer obj) {
+  if (!this->fields) {
+    auto ref = static_cast<ObjRowRef*>(this);
+
+    if (!ref->vec->columns)
+      return ref->vec->list[ref->row]->As<ObjInstance>()->set_mvar(index, std::move(obj));
+
+    return ref->vec->columns->Set(ref->row, index, std::move(obj));
+  }
+
+  auto const& f = this->ast->layout[index];
+  auto p = this->fields + f.offset;
+
+  if (f.kind == TypeKind::None)
+    *reinterpret_cast<ObjPointer*>(p) = std::move(obj);
+  else
+    *reinterpret_cast<u64*>(p) = obj->As<ObjPrimitive>()->_data;
+}
+
 ObjPointer ObjInstance::Clone() const {
-  auto obj = ObjNew<ObjInstance>(this->ast);
+  if (auto p = CloneMemo::Find(this); p)
+    return p;
+
+  auto obj = New(this->ast);
 
-  for (auto&& m : this->member_variables) {
-    obj->add_member_var(m->Clone());
+  CloneMemo::Add(this, obj);
+
+  if (!this->fields) {
+    for (size_t i = 0; i < this->ast->layout.size(); i++)
+      obj->set_mvar(i, this->get_mvar(i)->Clone());
+
+    return obj;
+  }
+
+  for (auto&& f : this->ast->layout) {
+    if (f.kind == TypeKind::None)
+      *reinterpret_cast<ObjPointer*>(obj->fields + f.offset) =
+          (*reinterpret_cast<ObjPointer*>(this->fields + f.offset))->Clone();
+    else
+      *reinterpret_cast<u64*>(obj->fields + f.offset) =
+          *reinterpret_cast<u64*>(this->fields + f.offset);
   }
 
   return obj;
 }
 
 string ObjInstance::ToString() const {
-  i64 _index = 0;
-
   auto const& mvarlist = this->ast->member_variables;
 
-  return this->ast->GetName() + "{" +
-         utils::join<ObjPointer>(", ", this->member_variables,
-                                 [&mvarlist, &_index](ObjPointer obj) {
-                                   return mvarlist[_index++]->GetName() + ": " +
-                                          obj->ToStringAsMember();
-                                 }) +
-         "}";
+  string ret;
+
+  for (size_t i = 0; i < mvarlist.size(); i++) {
+    if (i > 0)
+      ret += ", ";
+
+    ret += mvarlist[i]->GetName() + ": " + this->get_mvar(i)->ToStringAsMember();
+  }
+
+  return this->ast->GetName() + "{" + ret + "}";
 }
 
 ObjInstance::ObjInstance(ASTPtr<AST::Class> ast)
-    : Object(TypeKind::Instance),
+    : Object(ast->instance_type),
       ast(ast) {
-  this->type.name = ast->GetName();
+}
+
+void ObjInstance::Trace(vector<Object*>& out) const {
+  if (!this->fields)
+    return;
+
+  for (auto&& f : this->ast->layout)
+    if (f.kind == TypeKind::None)
+      if (auto& p = *reinterpret_cast<ObjPointer*>(this->fields + f.offset); p)
+        out.emplace_back(p.get());
+}
+
+void ObjInstance::ClearRefs() {
+  if (!this->fields)
+    return;
+
+  for (auto&& f : this->ast->layout)
+    if (f.kind == TypeKind::None)
+      *reinterpret_cast<ObjPointer*>(this->fields + f.offset) = nullptr;
+}
+
+ObjInstance::~ObjInstance() {
+  if (!this->fields)
+    return;
+
+  for (auto&& f : this->ast->layout)
+    if (f.kind == TypeKind::None)
+      reinterpret_cast<ObjPointer*>(this->fields + f.offset)->~ObjPointer();
 }
 
 // ----------------------------
@@ -215,7 +684,7 @@ ObjPointer ObjCallable::Clone() const {
 }
 
 string ObjCallable::ToString() const {
-  auto _args = this->type.params;
+  auto _args = this->type->params;
 
   _args.erase(_args.begin());
 
@@ -224,7 +693,7 @@ string ObjCallable::ToString() const {
                                [](TypeInfo const& t) {
                                  return t.to_string();
                                }) +
-         ") -> " + this->type.params[0].to_string() + ">";
+         ") -> " + this->type->params[0].to_string() + ">";
 }
 
 ObjCallable::ObjCallable(ASTPtr<AST::Function> fp)
@@ -266,14 +735,21 @@ std::string ObjType::ToString() const {
 ObjType::ObjType(ASTPtr<AST::Enum> x)
     : Object(TypeKind::TypeName),
       ast_enum(x) {
-  if (x)
-    this->type.name = this->ast_enum->GetName();
+  if (x) {
+    TypeInfo type = TypeKind::TypeName;
+
+    type.name = this->ast_enum->GetName();
+    this->type = type;
+  }
 }
 
 ObjType::ObjType(ASTPtr<AST::Class> x)
     : Object(TypeKind::TypeName),
       ast_class(x) {
-  this->type.name = this->ast_class->GetName();
+  TypeInfo type = TypeKind::TypeName;
+
+  type.name = this->ast_class->GetName();
+  this->type = type;
 }
 
 // ----------------------------
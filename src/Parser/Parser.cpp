@@ -33,7 +33,7 @@ ASTPointer Parser::Stmt() {
     throw Error(tok, "not terminated block");
   }
 
-  if (this->eat("match")) {
+  if (this->eat(Keyword::Match)) {
     auto ast = AST::Match::New(tok, this->Expr(), {});
 
     this->expect("{");
@@ -59,7 +59,7 @@ ASTPointer Parser::Stmt() {
     return ast;
   }
 
-  if (this->eat("if")) {
+  if (this->eat(Keyword::If)) {
     auto cond = this->Expr();
 
     this->expect("{", true);
@@ -67,8 +67,8 @@ ASTPointer Parser::Stmt() {
 
     ASTPointer if_false = nullptr;
 
-    if (this->eat("else")) {
-      if (!this->eat("if"))
+    if (this->eat(Keyword::Else)) {
+      if (!this->eat(Keyword::If))
         this->expect("{", true);
 
       if_false = this->Stmt();
@@ -77,7 +77,7 @@ ASTPointer Parser::Stmt() {
     return AST::Statement::NewIf(tok, cond, if_true, if_false);
   }
 
-  if (this->eat("while")) {
+  if (this->eat(Keyword::While)) {
     auto cond = this->Expr();
 
     this->expect("{", true);
@@ -86,10 +86,59 @@ ASTPointer Parser::Stmt() {
     return AST::Statement::NewWhile(tok, cond, block);
   }
 
-  if (this->eat("for")) {
+  // parallel for <name> in <begin> .. <end> [reduce(<op>) into <acc>] { }
+  if (this->match(Keyword::Parallel, Keyword::For)) {
+    this->cur += 2;
+
+    auto varname = *this->expectIdentifier();
+
+    this->expect("in");
+    auto begin = this->Expr();
+
+    this->expect("..");
+    auto end = this->Expr();
+
+    ASTKind op = ASTKind::Add;
+    ASTPointer acc = nullptr;
+
+    if (this->eat(Keyword::Reduce)) {
+      this->expect("(");
+
+      if (this->eat("*"))
+        op = ASTKind::Mul;
+      else
+        this->expect("+");
+
+      this->expect(")");
+      this->expect("into");
+
+      acc = AST::Identifier::New(*this->expectIdentifier());
+    }
+
+    this->expect("{", true);
+    auto block = ASTCast<AST::Block>(this->Stmt());
+
+    return AST::Statement::NewParallelFor(tok, varname, begin, end, block, op, acc);
+  }
+
+  if (this->eat(Keyword::For)) {
+    // for <name> in <iterable> { }
+    if (this->match(TokenKind::Identifier, Keyword::In)) {
+      auto varname = *this->cur++;
+
+      this->expect("in");
+
+      auto iterable = this->Expr();
+
+      this->expect("{", true);
+      auto block = ASTCast<AST::Block>(this->Stmt());
+
+      return AST::Statement::NewForEach(tok, varname, iterable, block);
+    }
+
     ASTPointer init = nullptr, cond = nullptr, step = nullptr;
 
-    if (this->match("let")) {
+    if (this->match(Keyword::Let)) {
       init = this->Stmt();
     }
     else if (!this->eat(";")) {
@@ -120,7 +169,7 @@ ASTPointer Parser::Stmt() {
                                                                                 }))});
   }
 
-  if (this->eat("return")) {
+  if (this->eat(Keyword::Return)) {
     if (this->eat(";")) {
       return AST::Statement::New(ASTKind::Return, tok);
     }
@@ -131,7 +180,14 @@ ASTPointer Parser::Stmt() {
     return ast;
   }
 
-  if (this->eat("break")) {
+  if (this->eat(Keyword::Yield)) {
+    auto ast = AST::Statement::NewExpr(ASTKind::Yield, tok, this->Expr());
+
+    this->expect(";");
+    return ast;
+  }
+
+  if (this->eat(Keyword::Break)) {
     if (!this->_in_loop)
       throw Error(tok, "cannot use 'break' out of loop statement");
 
@@ -141,7 +197,7 @@ ASTPointer Parser::Stmt() {
     return ast;
   }
 
-  if (this->eat("continue")) {
+  if (this->eat(Keyword::Continue)) {
     if (!this->_in_loop)
       throw Error(tok, "cannot use 'continue' out of loop statement");
 
@@ -151,14 +207,31 @@ ASTPointer Parser::Stmt() {
     return ast;
   }
 
-  if (this->eat("throw")) {
+  if (this->eat(Keyword::Throw)) {
     auto ast = AST::Statement::NewExpr(ASTKind::Throw, tok, this->Expr());
 
     this->expect(";");
     return ast;
   }
 
-  if (this->eat("let")) {
+  if (this->eat(Keyword::Let)) {
+    // let (a, b) = tuple;
+    if (this->eat("(")) {
+      auto ast = AST::VarDef::New(tok, *this->ate);
+
+      do {
+        ast->unpack.emplace_back(AST::VarDef::New(tok, *this->expectIdentifier()));
+      } while (this->eat(","));
+
+      this->expect(")");
+      this->expect("=");
+
+      ast->init = this->Expr();
+
+      this->expect(";");
+      return ast;
+    }
+
     auto ast = AST::VarDef::New(tok, *this->expectIdentifier());
 
     if (this->eat(":"))
@@ -171,13 +244,13 @@ ASTPointer Parser::Stmt() {
     return ast;
   }
 
-  if (this->eat("try")) {
+  if (this->eat(Keyword::Try)) {
     this->expect("{", true);
     auto block = ASTCast<AST::Block>(this->Stmt());
 
     vector<AST::Statement::TryCatch::Catcher> catchers;
 
-    while (this->eat("catch")) {
+    while (this->eat(Keyword::Catch)) {
       auto name = *this->expectIdentifier();
 
       this->expect(":");
@@ -204,7 +277,7 @@ ASTPointer Parser::Top() {
   auto tok = *this->cur;
   auto iter = this->cur;
 
-  if (this->eat("enum")) {
+  if (this->eat(Keyword::Enum)) {
     auto ast = AST::Enum::New(tok, *this->expectIdentifier());
 
     this->expect("{");
@@ -245,7 +318,7 @@ ASTPointer Parser::Top() {
     return ast;
   }
 
-  if (this->eat("class")) {
+  if (this->eat(Keyword::Class)) {
     auto ast = AST::Class::New(tok, *this->expectIdentifier());
 
     this->expect("{");
@@ -269,7 +342,7 @@ ASTPointer Parser::Top() {
 
     // member functions
     while (this->check() && !(closed = this->eat("}"))) {
-      if (!this->match("fn", TokenKind::Identifier))
+      if (!this->match(Keyword::Fn, TokenKind::Identifier))
         throw Error(*this->cur, "expected definition of member function");
 
       ast->append_func(ASTCast<AST::Function>(this->Top()));
@@ -284,7 +357,29 @@ ASTPointer Parser::Top() {
     return ast;
   }
 
-  if (this->eat("fn")) {
+  // async fn f() -> T  ==>  fn f() -> future<T>
+  if (this->eat(Keyword::Async)) {
+    if (!this->match(Keyword::Fn))
+      throw Error(*this->cur, "expected 'fn' after 'async'");
+
+    auto func = ASTCast<AST::Function>(this->Top());
+
+    auto name = tok;
+
+    name.str = "future";
+    auto type = AST::TypeName::New(name);
+
+    name.str = "none";
+    type->type_params.emplace_back(func->return_type ? func->return_type
+                                                     : AST::TypeName::New(name));
+
+    func->return_type = type;
+    func->is_async = true;
+
+    return func;
+  }
+
+  if (this->eat(Keyword::Fn)) {
     auto func = AST::Function::New(tok, *this->expectIdentifier());
 
     if (this->eat_typeparam_bracket_open()) {
@@ -300,7 +395,7 @@ ASTPointer Parser::Top() {
 
     this->expect("(");
 
-    if (auto tokkk = this->cur; this->_in_class && this->eat("self")) {
+    if (auto tokkk = this->cur; this->_in_class && this->eat(Keyword::Self)) {
       func->member_of = this->_classptr;
 
       if (!this->eat(","))
@@ -330,7 +425,7 @@ ASTPointer Parser::Top() {
     return func;
   }
 
-  if (this->eat("namespace")) {
+  if (this->eat(Keyword::Namespace)) {
     auto ast = AST::Block::New(*this->expectIdentifier());
 
     ast->kind = ASTKind::Namespace;
@@ -359,7 +454,7 @@ ASTPointer Parser::Top() {
 ASTPtr<AST::Block> Parser::Parse() {
   auto ret = AST::Block::New(*this->cur);
 
-  while (this->eat("include")) {
+  while (this->eat(Keyword::Include)) {
     todo_impl;
   }
 
@@ -7,6 +7,56 @@
 
 namespace fire::parser {
 
+//
+// contents of char or string literal, with escape sequences replaced.
+//  (source is read only, so a new string is made)
+//
+static string unescape(Token const& tok) {
+  auto s = tok.str.substr(1, tok.str.length() - 2);
+
+  string ret;
+
+  ret.reserve(s.length());
+
+  for (size_t i = 0; i < s.length(); i++) {
+    if (s[i] != '\\') {
+      ret += s[i];
+      continue;
+    }
+
+    switch (i + 1 < s.length() ? s[i + 1] : 0) {
+    case 'n':
+      ret += '\n';
+      break;
+
+    case 'r':
+      ret += '\r';
+      break;
+
+    case 't':
+      ret += '\t';
+      break;
+
+    case '\\':
+      ret += '\\';
+      break;
+
+    default: {
+      auto loc = tok;
+
+      loc.sourceloc.position += (u32)i + 1;
+      loc.sourceloc.length = 2;
+
+      throw Error(loc, "invalid escape sequence");
+    }
+    }
+
+    i++;
+  }
+
+  return ret;
+}
+
 static ObjPtr<ObjPrimitive> make_value_from_token(Token const& tok) {
   auto k = tok.kind;
   auto const& s = tok.str;
@@ -27,7 +77,7 @@ static ObjPtr<ObjPrimitive> make_value_from_token(Token const& tok) {
   }
 
   case TokenKind::Char: {
-    auto s16 = utils::to_u16string(string(s.substr(1, s.length() - 2)));
+    auto s16 = utils::to_u16string(unescape(tok));
 
     if (s16.length() != 1)
       throw Error(tok, "the length of character literal is must 1.");
@@ -55,7 +105,26 @@ static ObjPtr<ObjPrimitive> make_value_from_token(Token const& tok) {
 ASTPointer Parser::Factor() {
 
   if (this->eat("(")) {
+    auto& tok = *this->ate;
     auto x = this->Expr();
+
+    // tuple
+    //  (a, b, ...)
+    if (this->eat(",")) {
+      auto t = AST::Tuple::New(tok);
+
+      t->elements.emplace_back(x);
+
+      if (!this->match(")")) {
+        do {
+          t->elements.emplace_back(this->Expr());
+        } while (this->eat(","));
+      }
+
+      this->expect(")");
+      return t;
+    }
+
     this->expect(")");
     return x;
   }
@@ -74,37 +143,28 @@ ASTPointer Parser::Factor() {
     return x;
   }
 
-  auto& tok = *this->cur++;
-
-  if (tok.kind == TokenKind::Char || tok.kind == TokenKind::String) {
-    auto it = tok.str.begin();
-    auto end = tok.str.end();
-
-    while (it != end) {
-      if (*it == '\\') {
-        size_t index = tok.sourceloc.position + (it - tok.str.begin());
+  // dict
+  //  {key: value, ...}
+  if (this->eat("{")) {
+    auto x = AST::Dict::New(*this->ate);
 
-        switch (it[1]) {
-        case 'n':
-          tok.get_src_data().replace(index, index + 2, "\n");
-          break;
-
-        case 'r':
-          tok.get_src_data().replace(index, index + 2, "\r");
-          break;
+    if (!this->eat("}")) {
+      do {
+        auto key = this->Expr();
 
-        default:
-          tok.sourceloc.position += (end - it);
-          tok.sourceloc.length = 1;
+        this->expect(":");
 
-          throw Error(tok, "invalid escape sequence");
-        }
-      }
+        x->elements.emplace_back(key, this->Expr());
+      } while (this->eat(","));
 
-      it++;
+      this->expect("}");
     }
+
+    return x;
   }
 
+  auto& tok = *this->cur++;
+
   switch (tok.kind) {
   case TokenKind::Int:
   case TokenKind::Float:
@@ -114,8 +174,7 @@ ASTPointer Parser::Factor() {
     return AST::Value::New(tok, make_value_from_token(tok));
 
   case TokenKind::String: {
-    auto xx = AST::Value::New(
-        tok, ObjNew<ObjString>(string(tok.str.substr(1, tok.str.length() - 2))));
+    auto xx = AST::Value::New(tok, ObjNew<ObjString>(unescape(tok)));
 
     return xx;
   }
@@ -173,7 +232,7 @@ ASTPointer Parser::ScopeResol() {
   //
   // overload-reslotion-guide
   //
-  if (this->eat("of")) {
+  if (this->eat(Keyword::Of)) {
     if (!x->is_ident_or_scoperesol())
       throw Error(*this->ate, "invalid syntax");
 
@@ -187,7 +246,7 @@ ASTPointer Parser::ScopeResol() {
 
 ASTPointer Parser::Lambda() {
 
-  if (this->eat("lambda")) {
+  if (this->eat(Keyword::Lambda)) {
     auto tok = *this->ate;
 
     this->expect("(");
@@ -282,6 +341,10 @@ ASTPointer Parser::IndexRef() {
 ASTPointer Parser::Unary() {
   auto& tok = *this->cur;
 
+  if (this->eat(Keyword::Await)) {
+    return new_expr(ASTKind::Await, tok, this->Unary(), nullptr);
+  }
+
   if (this->eat("-")) {
     return new_expr(ASTKind::Sub, tok, AST::Value::New("0", ObjNew<ObjPrimitive>((i64)0)),
                     this->IndexRef());
@@ -291,154 +354,166 @@ ASTPointer Parser::Unary() {
   return this->IndexRef();
 }
 
-ASTPointer Parser::Mul() {
-  auto x = this->Unary();
-
-  while (this->check()) {
-    auto& op = *this->cur;
-
-    if (this->eat("*"))
-      x = new_expr(ASTKind::Mul, op, x, this->Unary());
-    else if (this->eat("/"))
-      x = new_expr(ASTKind::Div, op, x, this->Unary());
-    else
-      break;
-  }
-
-  return x;
+//
+// binary operators
+//
+//  looked up by token, and parsed by precedence climbing in Binary().
+//  higher precedence binds tighter.
+//  all are left associative except assignments.
+//
+enum Precedence : int {
+  Prec_None,
+  Prec_Assign,
+  Prec_LogAndOr,
+  Prec_Bit,
+  Prec_Compare,
+  Prec_Shift,
+  Prec_Add,
+  Prec_Mul,
+};
+
+struct BinaryOp {
+  enum Form : u8 {
+    Normal,
+    Swap,     // a < b  -->  b > a
+    NotEqual, // a != b  -->  !(a == b)
+    Compound, // a += b  -->  a = a + b
+  };
+
+  ASTKind kind = ASTKind::Value;
+  Precedence prec = Prec_None;
+  Form form = Normal;
+};
+
+static constexpr u16 pair(char a, char b) {
+  return (u16)((u8)a << 8 | (u8)b);
 }
 
-ASTPointer Parser::Add() {
-  auto x = this->Mul();
+static BinaryOp get_binary_op(Token const& tok) {
+  if (tok.kind != TokenKind::Punctuater)
+    return {};
 
-  while (this->check()) {
-    auto& op = *this->cur;
+  auto const& s = tok.str;
 
-    if (this->eat("+"))
-      x = new_expr(ASTKind::Add, op, x, this->Mul());
-    else if (this->eat("-"))
-      x = new_expr(ASTKind::Sub, op, x, this->Mul());
-    else
-      break;
+  if (s.length() == 1) {
+    switch (s[0]) {
+    case '*':
+      return {ASTKind::Mul, Prec_Mul};
+    case '/':
+      return {ASTKind::Div, Prec_Mul};
+
+    case '+':
+      return {ASTKind::Add, Prec_Add};
+    case '-':
+      return {ASTKind::Sub, Prec_Add};
+
+    case '>':
+      return {ASTKind::Bigger, Prec_Compare};
+    case '<':
+      return {ASTKind::Bigger, Prec_Compare, BinaryOp::Swap};
+
+    case '&':
+      return {ASTKind::BitAND, Prec_Bit};
+    case '^':
+      return {ASTKind::BitXOR, Prec_Bit};
+    case '|':
+      return {ASTKind::BitOR, Prec_Bit};
+
+    case '=':
+      return {ASTKind::Assign, Prec_Assign};
+    }
   }
 
-  return x;
-}
-
-ASTPointer Parser::Shift() {
-  auto x = this->Add();
-
-  while (this->check()) {
-    auto& op = *this->cur;
-
-    if (this->eat("<<"))
-      x = new_expr(ASTKind::LShift, op, x, this->Add());
-    else if (this->eat(">>"))
-      x = new_expr(ASTKind::RShift, op, x, this->Add());
-    else
-      break;
+  else if (s.length() == 2) {
+    switch (pair(s[0], s[1])) {
+    case pair('<', '<'):
+      return {ASTKind::LShift, Prec_Shift};
+    case pair('>', '>'):
+      return {ASTKind::RShift, Prec_Shift};
+
+    case pair('=', '='):
+      return {ASTKind::Equal, Prec_Compare};
+    case pair('!', '='):
+      return {ASTKind::Equal, Prec_Compare, BinaryOp::NotEqual};
+    case pair('>', '='):
+      return {ASTKind::BiggerOrEqual, Prec_Compare};
+    case pair('<', '='):
+      return {ASTKind::BiggerOrEqual, Prec_Compare, BinaryOp::Swap};
+
+    case pair('&', '&'):
+      return {ASTKind::LogAND, Prec_LogAndOr};
+    case pair('|', '|'):
+      return {ASTKind::LogOR, Prec_LogAndOr};
+
+    case pair('*', '='):
+      return {ASTKind::Mul, Prec_Assign, BinaryOp::Compound};
+    case pair('/', '='):
+      return {ASTKind::Div, Prec_Assign, BinaryOp::Compound};
+    case pair('+', '='):
+      return {ASTKind::Add, Prec_Assign, BinaryOp::Compound};
+    case pair('-', '='):
+      return {ASTKind::Sub, Prec_Assign, BinaryOp::Compound};
+    }
   }
 
-  return x;
+  return {};
 }
 
-ASTPointer Parser::Compare() {
-  auto x = this->Shift();
+//
+// parse operands and binary operators which precedence is min_prec or higher.
+//
+ASTPointer Parser::Binary(int min_prec) {
+  auto x = this->Unary();
 
-  int count = 0;
-  TokenIterator _tok = this->cur;
+  int compare_count = 0;
+  TokenIterator first_compare = this->cur;
 
   while (this->check()) {
-    auto& op = *this->cur;
+    auto op = get_binary_op(*this->cur);
 
-    if (this->eat("=="))
-      x = new_expr(ASTKind::Equal, op, x, this->Shift());
-    else if (this->eat("!="))
-      x = new_expr(ASTKind::Not, op, new_expr(ASTKind::Equal, op, x, this->Shift()),
-                   nullptr);
-    else if (this->eat(">"))
-      x = new_expr(ASTKind::Bigger, op, x, this->Shift());
-    else if (this->eat("<"))
-      x = new_expr(ASTKind::Bigger, op, this->Shift(), x);
-    else if (this->eat(">="))
-      x = new_expr(ASTKind::BiggerOrEqual, op, x, this->Shift());
-    else if (this->eat("<="))
-      x = new_expr(ASTKind::BiggerOrEqual, op, this->Shift(), x);
-    else
+    if (op.prec == Prec_None || op.prec < min_prec)
       break;
 
-    if (++count >= 2) {
-      if (_tok->str == "<" && (_tok - 1)->kind == TokenKind::Identifier) {
-        throw Error(op, "compare operator cannot be chained")
-            .AddNote("if you want to give template argument, write as '@<...>'");
-      }
-    }
-  }
+    auto opit = this->cur++;
+    auto& tok = *opit;
 
-  return x;
-}
+    // assignments are right associative
+    auto rhs = this->Binary(op.prec == Prec_Assign ? op.prec : op.prec + 1);
 
-ASTPointer Parser::BitCalc() {
-  auto x = this->Compare();
-
-  while (this->check()) {
-    auto& op = *this->cur;
-
-    if (this->eat("&"))
-      x = new_expr(ASTKind::BitAND, op, x, this->Compare());
-    else if (this->eat("^"))
-      x = new_expr(ASTKind::BitXOR, op, x, this->Compare());
-    else if (this->eat("|"))
-      x = new_expr(ASTKind::BitOR, op, x, this->Compare());
-    else
+    switch (op.form) {
+    case BinaryOp::Normal:
+      x = new_expr(op.kind, tok, x, rhs);
       break;
-  }
-
-  return x;
-}
 
-ASTPointer Parser::LogAndOr() {
-  auto x = this->BitCalc();
-
-  while (this->check()) {
-    auto& op = *this->cur;
-
-    if (this->eat("&&"))
-      x = new_expr(ASTKind::LogAND, op, x, this->BitCalc());
-    else if (this->eat("||"))
-      x = new_expr(ASTKind::LogOR, op, x, this->BitCalc());
-    else
+    case BinaryOp::Swap:
+      x = new_expr(op.kind, tok, rhs, x);
       break;
-  }
 
-  return x;
-}
+    case BinaryOp::NotEqual:
+      x = new_expr(ASTKind::Not, tok, new_expr(op.kind, tok, x, rhs), nullptr);
+      break;
 
-ASTPointer Parser::Assign() {
-  auto x = this->LogAndOr();
+    case BinaryOp::Compound:
+      x = new_assign(op.kind, tok, x, rhs);
+      break;
+    }
 
-  while (this->check()) {
-    auto& op = *this->cur;
+    if (op.prec == Prec_Compare && ++compare_count == 1)
+      first_compare = opit;
 
-    if (this->eat("="))
-      x = new_expr(ASTKind::Assign, op, x, this->Assign());
-    else if (this->eat("*="))
-      x = new_assign(ASTKind::Mul, op, x, this->Assign());
-    else if (this->eat("/="))
-      x = new_assign(ASTKind::Div, op, x, this->Assign());
-    else if (this->eat("+="))
-      x = new_assign(ASTKind::Add, op, x, this->Assign());
-    else if (this->eat("-="))
-      x = new_assign(ASTKind::Sub, op, x, this->Assign());
-    else
-      break;
+    if (compare_count >= 2 && op.prec == Prec_Compare) {
+      if (first_compare->str == "<" && (first_compare - 1)->kind == TokenKind::Identifier) {
+        throw Error(tok, "compare operator cannot be chained")
+            .AddNote("if you want to give template argument, write as '@<...>'");
+      }
+    }
   }
 
   return x;
 }
 
 ASTPointer Parser::Expr() {
-  return this->Assign();
+  return this->Binary(Prec_Assign);
 }
 
 } // namespace fire::parser
\ No newline at end of file
@@ -20,6 +20,15 @@ bool Parser::eat(std::string_view str) {
   return false;
 }
 
+bool Parser::eat(Keyword kw) {
+  if (this->check() && this->cur->keyword == kw) {
+    this->ate = this->cur++;
+    return true;
+  }
+
+  return false;
+}
+
 void Parser::expect(std::string_view str, bool keep_token) {
   if (!this->eat(str)) {
     if (this->cur == this->end)
@@ -50,9 +59,16 @@ void Parser::expect_typeparam_bracket_open() {
 }
 
 bool Parser::eat_typeparam_bracket_close() {
+  // ">>" closes two brackets.
+  //  first '>' is eaten by dropping it from the token, so the rest is
+  //  seen as '>' by next call. (no insertion into token list)
   if (_typeparam_bracket_depth >= 1 && this->match(">>")) {
-    this->cur->str = ">";
-    this->cur = this->insert_token(">");
+    this->cur->str = this->cur->str.substr(1);
+    this->cur->sourceloc.position++;
+    this->cur->sourceloc.length = 1;
+
+    _typeparam_bracket_depth--;
+    return true;
   }
 
   if (this->eat(">")) {
@@ -2,7 +2,7 @@
 
 namespace fire::semantics_checker {
 
-static vector<Sema*> _sema_instances;
+static thread_local vector<Sema*> _sema_instances;
 
 Sema* Sema::GetInstance() {
   return *_sema_instances.rbegin();
@@ -20,7 +20,7 @@ static string scope2s_var(string indent, string ns,
   for (auto&& v : lvar) {
     ret +=
         indent + utils::Format("  '%.*s': decl=%p, distance=%d, index=%d, index_add=%d\n",
-                               (int)v.name.length(), v.name.data(), v.decl.get(), v.depth,
+                               (int)v.name.length(), v.name.data(), v.decl, v.depth,
                                v.index, v.index_add);
   }
 
@@ -48,7 +48,7 @@ static string scope2s(ScopeContext* scope) {
   _indent++;
 
   ret += indent + utils::Format("  depth = %d,\n%s  ast = %p,\n%s  _owner = %p\n",
-                                scope->depth, indent.c_str(), scope->GetAST().get(),
+                                scope->depth, indent.c_str(), scope->GetAST(),
                                 indent.c_str(), scope->_owner);
 
   switch (scope->type) {
@@ -104,10 +104,25 @@ Sema::Sema(ASTPtr<AST::Block> prg)
   // todo_impl;
 }
 
+//
+// worker for check_functions_parallel. (made on the thread of worker)
+// shares scopes with parent, and starts at top level of program.
+//
+Sema::Sema(Sema* parent)
+    : root(parent->root),
+      _scope_context(parent->_scope_context),
+      parent(parent) {
+  _sema_instances.emplace_back(this);
+
+  this->_scope_history.emplace_front(this->_scope_context);
+  this->_scope_history.emplace_front(this->GetScopeOf(this->root));
+}
+
 Sema::~Sema() {
   _sema_instances.pop_back();
 
-  delete this->_scope_context;
+  if (!this->parent)
+    delete this->_scope_context;
 }
 
 } // namespace fire::semantics_checker
\ No newline at end of file
@@ -13,8 +13,123 @@
 
 namespace fire::semantics_checker {
 
-void Sema::check_full() {
+//
+// build decision tree of match statement.
+//
+//  patterns after first "_" or variable are never reached.
+//  if any other pattern is not a constant, patterns are tested in order.
+//
+static void build_match_dispatch(ASTPtr<AST::Match> x, TypeInfo const& cond) {
+  using Type = AST::Match::Pattern::Type;
+  using Dispatch = AST::Match::Dispatch;
+
+  bool is_enum = cond.kind == TypeKind::Enumerator;
+  bool is_int = cond.is_hit_kind({TypeKind::Int, TypeKind::Char, TypeKind::Bool});
+
+  x->dispatch = Dispatch::Linear;
+  x->table.clear();
+  x->enum_table.clear();
+  x->hash.clear();
+  x->fallback = -1;
+
+  if (!is_enum && !is_int && cond.kind != TypeKind::String)
+    return;
+
+  Vec<std::pair<ObjPointer, u32>> keys;
+  Vec<std::pair<size_t, u32>> enum_keys;
+
+  for (u32 i = 0; auto&& P : x->patterns) {
+    if (P.type == Type::AllCases || P.type == Type::Variable) {
+      x->fallback = (i32)i;
+      break;
+    }
+
+    if (is_enum) {
+      switch (P.expr->kind) {
+      case ASTKind::Enumerator:
+        enum_keys.emplace_back(P.expr->GetID()->index, i);
+        break;
+
+      case ASTKind::CallFunc_Enumerator:
+        enum_keys.emplace_back(ASTCast<AST::CallFunc>(P.expr)->enum_index, i);
+        break;
+
+      case ASTKind::CallFunc:
+        if (P.type != Type::EnumeratorWithArguments)
+          return;
+
+        enum_keys.emplace_back(
+            ASTCast<AST::CallFunc>(P.expr)->callee->GetID()->index, i);
+        break;
+
+      default:
+        return;
+      }
+    }
+    else if (P.type == Type::ExprEval && P.expr->kind == ASTKind::Value) {
+      keys.emplace_back(P.expr->as_value()->value, i);
+    }
+    else {
+      return;
+    }
+
+    i++;
+  }
+
+  if (is_enum) {
+    x->dispatch = Dispatch::Enumerator;
+    x->enum_table.resize(cond.type_ast->As<AST::Enum>()->enumerators.size());
+
+    for (auto&& [index, i] : enum_keys)
+      x->enum_table[index].emplace_back(i);
+
+    return;
+  }
+
+  if (keys.empty())
+    return;
+
+  if (is_int) {
+    i64 min = keys[0].first->As<ObjPrimitive>()->as_integer();
+    i64 max = min;
+
+    for (auto&& [k, i] : keys) {
+      min = std::min(min, k->As<ObjPrimitive>()->as_integer());
+      max = std::max(max, k->As<ObjPrimitive>()->as_integer());
+    }
+
+    // (max - min can overflow i64)
+    u64 span = (u64)max - (u64)min;
+
+    // dense enough for jump table
+    if (span < keys.size() * 4 + 16) {
+      x->dispatch = Dispatch::Table;
+      x->table_base = min;
+      x->table.assign(span + 1, -1);
+
+      for (auto&& [k, i] : keys)
+        if (auto& p = x->table[(u64)k->As<ObjPrimitive>()->as_integer() - (u64)min];
+            p == -1)
+          p = (i32)i;
+
+      return;
+    }
+  }
+
+  x->dispatch = Dispatch::Hash;
+
+  for (auto&& [k, i] : keys)
+    x->hash.try_emplace(k, i);
+}
+
+void Sema::check_full(size_t jobs) {
+  if (jobs >= 2)
+    this->check_functions_parallel(jobs);
+
   this->check(this->root);
+
+  for (auto&& x : this->parallel_for_list)
+    this->check_parallel_for(x);
 }
 
 void Sema::check(ASTPointer ast) {
@@ -73,6 +188,25 @@ void Sema::check(ASTPointer ast) {
       this->check(mv->init);
     }
 
+    x->layout.clear();
+    x->fields_size = 0;
+
+    for (auto&& mv : x->member_variables) {
+      auto& f = x->layout.emplace_back();
+
+      f.offset = x->fields_size;
+
+      if (auto type = this->eval_type(mv->type ? mv->type : mv->init);
+          type->is_hit_kind({TypeKind::Int, TypeKind::Float, TypeKind::Bool,
+                            TypeKind::Char})) {
+        f.kind = type.kind;
+        x->fields_size += sizeof(u64);
+      }
+      else {
+        x->fields_size += sizeof(ObjPointer);
+      }
+    }
+
     for (auto&& mf : x->member_functions) {
       this->check(mf);
     }
@@ -83,18 +217,20 @@ void Sema::check(ASTPointer ast) {
   case ASTKind::Function: {
     auto x = ASTCast<AST::Function>(ast);
 
-    // auto func = this->get_func(x);
-    // SemaFunction* func = nullptr;
-    FunctionScope* func = nullptr;
+    // already checked on other thread
+    if (auto checked = this->checked_functions.find(x); checked) {
+      if (checked->error)
+        std::rethrow_exception(checked->error);
 
-    for (auto&& [_Key, _Val] : this->function_scope_map) {
-      if (_Key == x) {
-        func = _Val;
-        break;
-      }
+      for (auto&& pf : checked->parallel_for_list)
+        this->parallel_for_list.emplace_back(pf);
+
+      break;
     }
 
-    assert(func);
+    // auto func = this->get_func(x);
+    // SemaFunction* func = nullptr;
+    FunctionScope* func = this->get_function_scope(x);
 
     if (func->is_templated()) {
       break;
@@ -110,23 +246,41 @@ void Sema::check(ASTPointer ast) {
 
     func->result_type = this->eval_type(x->return_type);
 
+    // body of async function returns T of future<T>
+    if (x->is_async) {
+      x->return_type->type = func->result_type;
+      func->result_type = func->result_type.params[0];
+    }
+
     this->EnterScope(x);
 
-    AST::walk_ast(func->block->ast, [&func](AST::ASTWalkerLocation loc, ASTPointer _ast) {
+    AST::walk_ast(func->block->ast, [&func, &x](AST::ASTWalkerLocation loc, ASTPointer _ast) {
       if (loc == AST::AW_Begin && _ast->kind == ASTKind::Return) {
         func->return_stmt_list.emplace_back(ASTCast<AST::Statement>(_ast));
       }
+      else if (loc == AST::AW_Begin && _ast->kind == ASTKind::Yield) {
+        x->is_generator = true;
+      }
     });
 
+    // body of generator yields T of generator<T>, and returns nothing.
+    if (x->is_generator) {
+      if (func->result_type.kind != TypeKind::Generator)
+        throw Error(x->token, "function with yield must return 'generator<T>'");
+
+      x->return_type->type = func->result_type;
+
+      func->yield_type = func->result_type.params[0];
+      func->result_type = TypeKind::None;
+    }
+
     if (!func->result_type.equals(TypeKind::None)) {
       if (func->return_stmt_list.empty()) {
-        Error(func->ast->token, "function must return value of type '" +
-                                    func->result_type.to_string() +
-                                    "', but don't return "
-                                    "anything.")
-            .emit();
-
-        throw Error(Error::ER_Note, func->ast->return_type, "specified here");
+        throw Error(func->ast->token, "function must return value of type '" +
+                                          func->result_type.to_string() +
+                                          "', but don't return "
+                                          "anything.")
+            .AddChain(Error(Error::ER_Note, func->ast->return_type, "specified here"));
       }
       else if (auto block = func->block;
                (*block->ast->list.rbegin())->kind != ASTKind::Return) {
@@ -162,6 +316,29 @@ void Sema::check(ASTPointer ast) {
     auto x = ASTCast<AST::VarDef>(ast);
     auto& curScope = this->GetCurScope();
 
+    // let (a, b, ...) = tuple;
+    if (!x->unpack.empty()) {
+      auto type = this->eval_type(x->init);
+
+      if (type.kind != TypeKind::Tuple) {
+        throw Error(x->init, "expected tuple, but found '" + type.to_string() + "'");
+      }
+
+      if (type->params.size() != x->unpack.size()) {
+        throw Error(x->init, "cannot unpack '" + type.to_string() + "' into " +
+                                 std::to_string(x->unpack.size()) + " variables");
+      }
+
+      for (size_t i = 0; i < x->unpack.size(); i++) {
+        auto& v = ((BlockScope*)curScope)->variables[x->unpack[i]->index];
+
+        v.deducted_type = type->params[i];
+        v.is_type_deducted = true;
+      }
+
+      break;
+    }
+
     ScopeContext::LocalVar& var = ((BlockScope*)curScope)->variables[x->index];
 
     if (x->type) {
@@ -170,15 +347,12 @@ void Sema::check(ASTPointer ast) {
     }
 
     if (x->init) {
-      auto type = this->eval_type(x->init);
-
-      if (x->type && !var.deducted_type.equals(type)) {
-        throw Error(x->init, "expected '" + var.deducted_type.to_string() +
-                                 "' type expression, but found '" + type.to_string() +
-                                 "'");
+      if (x->type) {
+        this->ExpectType(var.deducted_type, x->init);
+        break;
       }
 
-      var.deducted_type = type;
+      var.deducted_type = this->eval_type(x->init);
       var.is_type_deducted = true;
     }
 
@@ -270,7 +444,7 @@ void Sema::check(ASTPointer ast) {
 
           alertexpr(static_cast<int>(e_type.kind));
 
-          if (e_type.kind != TypeKind::Enumerator || e_type.type_ast != cond.type_ast) {
+          if (e_type.kind != TypeKind::Enumerator || e_type->type_ast != cond->type_ast) {
             todo_impl;
           }
 
@@ -351,6 +525,8 @@ void Sema::check(ASTPointer ast) {
       this->LeaveScope();
     }
 
+    build_match_dispatch(x, cond);
+
     break;
   }
 
@@ -368,6 +544,96 @@ void Sema::check(ASTPointer ast) {
     break;
   }
 
+  case ASTKind::ForEach: {
+    auto d = ast->as_stmt()->data_for_each;
+
+    auto type = this->eval_type(d->iterable);
+
+    switch (type.kind) {
+    case TypeKind::String:
+      d->_elem_type = TypeKind::Char;
+      break;
+
+    case TypeKind::Vector:
+    case TypeKind::Dict:    // iterate keys
+    case TypeKind::Channel: // receive until closed
+    case TypeKind::Generator:
+      // type of element is not known. (ex: vector + T)
+      if (type->params.empty())
+        throw Error(d->iterable, "cannot iterate '" + type.to_string() +
+                                     "' without type of element");
+
+      d->_elem_type = type->params[0];
+      break;
+
+    default:
+      throw Error(d->iterable, "'" + type.to_string() + "' type is not iterable");
+    }
+
+    auto var_scope = (BlockScope*)this->EnterScope(d->block);
+
+    auto& var = var_scope->variables[0];
+
+    var.deducted_type = d->_elem_type;
+    var.is_type_deducted = true;
+
+    this->check(d->block);
+
+    this->LeaveScope();
+
+    break;
+  }
+
+  case ASTKind::ParallelFor: {
+    auto d = ast->as_stmt()->data_parallel_for;
+
+    this->ExpectType(TypeKind::Int, d->begin);
+    this->ExpectType(TypeKind::Int, d->end);
+
+    if (d->acc) {
+      d->_acc_type = this->eval_type(d->acc);
+
+      if (d->acc->kind != ASTKind::Variable)
+        throw Error(d->acc, "expected variable");
+
+      if (!d->_acc_type.is_hit_kind({TypeKind::Int, TypeKind::Float}))
+        throw Error(d->acc, "reduction variable must be 'int' or 'float', but found '" +
+                                d->_acc_type.to_string() + "'");
+    }
+
+    auto var_scope = (BlockScope*)this->EnterScope(d->block);
+
+    auto& var = var_scope->variables[0];
+
+    var.deducted_type = TypeKind::Int;
+    var.is_type_deducted = true;
+
+    this->check(d->block);
+
+    this->LeaveScope();
+
+    AST::walk_ast(d->block, [&](AST::ASTWalkerLocation loc, ASTPointer x) {
+      if (loc != AST::AW_Begin || x->kind != ASTKind::Variable)
+        return;
+
+      auto name = x->GetID()->GetName();
+
+      for (auto&& ov : d->_outer_vectors)
+        if (ov.name == name)
+          return;
+
+      // found in scope out of the body (locals of body are not visible here)
+      if (auto pvar = this->_find_variable(name);
+          pvar && pvar->deducted_type.kind == TypeKind::Vector)
+        d->_outer_vectors.emplace_back(name, pvar->deducted_type, pvar->decl);
+    });
+
+    // writes in body are checked after called functions are checked.
+    this->parallel_for_list.emplace_back(ASTCast<AST::Statement>(ast));
+
+    break;
+  }
+
   case ASTKind::TryCatch: {
     auto d = ast->as_stmt()->data_try_catch;
 
@@ -404,6 +670,14 @@ void Sema::check(ASTPointer ast) {
     break;
   }
 
+  case ASTKind::Yield: {
+    if (!this->cur_function || !this->cur_function->ast->is_generator)
+      throw Error(ast, "yield outside of function");
+
+    this->ExpectType(this->cur_function->yield_type, ast->as_stmt()->expr);
+    break;
+  }
+
   case ASTKind::Throw: {
     this->check(ast->as_stmt()->expr);
     break;
@@ -10,7 +10,18 @@
 
 namespace fire::semantics_checker {
 
-TypeInfo Sema::eval_type(ASTPointer ast) {
+//
+// self type of builtin member without params matches to any params.
+// (ex: "vector" => vector<int>, vector<string>, ...)
+//
+static bool is_builtin_self_type(TypeInfo const& type, TypeInfo const& self_type) {
+  if (self_type.params.empty())
+    return type.without_params().equals(self_type);
+
+  return type.equals(self_type);
+}
+
+TypeId Sema::eval_type(ASTPointer ast) {
   using Kind = ASTKind;
 
   if (!ast)
@@ -42,12 +53,7 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
   case Kind::FuncName: {
     auto id = ast->GetID();
 
-    TypeInfo type = TypeKind::Function;
-
-    type.params = id->ft_args;
-    type.params.insert(type.params.begin(), id->ft_ret);
-
-    return type;
+    return id->get_ft_type();
   }
 
   case Kind::Array: {
@@ -56,7 +62,10 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
 
     if (x->elements.empty()) {
       if (this->IsExpected(TypeKind::Vector)) {
-        return x->elem_type = *this->GetExpectedType();
+        type = *this->GetExpectedType();
+        x->elem_type = type.params[0];
+
+        return type;
       }
 
       throw Error(x->token, "cannot deduction element type")
@@ -78,6 +87,52 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
     return type;
   }
 
+  case Kind::Tuple: {
+    auto x = ast->As<AST::Tuple>();
+
+    x->type = TypeKind::Tuple;
+
+    for (auto&& e : x->elements)
+      x->type.params.emplace_back(this->eval_type(e));
+
+    return x->type;
+  }
+
+  case Kind::Dict: {
+    auto x = ast->As<AST::Dict>();
+
+    if (x->elements.empty()) {
+      if (this->IsExpected(TypeKind::Dict)) {
+        return x->type = *this->GetExpectedType();
+      }
+
+      throw Error(x->token, "cannot deduction key and value type of empty dict")
+          .AddNote("specify type of variable. (like \"let d: dict<K, V> = {};\")");
+    }
+
+    auto keyType = this->eval_type(x->elements[0].first);
+    auto valueType = this->eval_type(x->elements[0].second);
+
+    if (!this->is_hashable(keyType)) {
+      throw Error(x->elements[0].first,
+                  "'" + keyType.to_string() + "' type is not hashable");
+    }
+
+    for (auto it = x->elements.begin() + 1; it != x->elements.end(); it++) {
+      if (!keyType.equals(this->eval_type(it->first))) {
+        throw Error(it->first,
+                    "expected '" + keyType.to_string() + "' type expression as key");
+      }
+
+      if (!valueType.equals(this->eval_type(it->second))) {
+        throw Error(it->second,
+                    "expected '" + valueType.to_string() + "' type expression as value");
+      }
+    }
+
+    return x->type = TypeInfo(TypeKind::Dict, {keyType, valueType});
+  }
+
   case Kind::OverloadResolutionGuide: {
     auto x = ASTCast<AST::Expr>(ast);
 
@@ -101,8 +156,8 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
     auto sig_ast = ASTCast<AST::Signature>(x->rhs);
     auto sig = this->eval_type(sig_ast);
 
-    auto const& sig_ret = sig.params[0];
-    auto const sig_args = TypeVec(sig.params.begin() + 1, sig.params.end());
+    auto const& sig_ret = sig->params[0];
+    auto const sig_args = TypeVec(sig->params.begin() + 1, sig->params.end());
 
     ASTVec<AST::Function> final_cd;
 
@@ -300,6 +355,15 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
         if (!this->try_apply_template_function(apply, func, id->template_args, {})) {
           return type;
         }
+
+        if (auto inst = this->get_checked_instance(apply); inst) {
+          type.params.emplace_back(id->ft_ret = inst->result_type);
+
+          for (auto&& t : inst->arg_types)
+            id->ft_args.emplace_back(type.params.emplace_back(t));
+
+          return type;
+        }
       }
 
       type.params.emplace_back(id->ft_ret = this->eval_type(func->return_type));
@@ -331,8 +395,12 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
 
       type.is_free_args = func->is_variable_args;
 
-      type.params = id->ft_args = func->arg_types;
-      type.params.insert(type.params.begin(), id->ft_ret = func->result_type);
+      type.params.emplace_back(id->ft_ret = func->result_type);
+
+      id->ft_args.clear();
+
+      for (auto&& t : func->arg_types)
+        id->ft_args.emplace_back(type.params.emplace_back(t));
 
       return type;
     }
@@ -516,6 +584,9 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
 
       ASTVec<AST::Function> final_candidates;
 
+      // result type of template instance (for final_candidates[0])
+      std::optional<TypeInfo> template_result;
+
       for (ASTPtr<AST::Function> candidate : id->candidates) {
         // if (id->id_params.size() > candidate->template_param_names.size())
         //   continue;
@@ -526,6 +597,10 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
 
           if (this->try_apply_template_function(apply, candidate, id->template_args,
                                                 arg_types)) {
+            if (auto inst = this->get_checked_instance(apply);
+                inst && final_candidates.empty())
+              template_result = inst->result_type;
+
             final_candidates.emplace_back(candidate);
           }
           else if (id->candidates.size() == 1) {
@@ -583,6 +658,9 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
 
       call->callee_ast = final_candidates[0];
 
+      if (template_result)
+        return *template_result;
+
       return this->eval_type(final_candidates[0]->return_type);
     }
 
@@ -590,16 +668,41 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
     case ASTKind::BuiltinFuncName: {
 
       for (builtins::Function const* fn : id->candidates_builtin) {
+        TypeVec formal = fn->arg_types;
+        TypeInfo result = fn->result_type;
+
+        if (functor->kind == ASTKind::BuiltinMemberFunction) {
+          for (auto&& t : formal)
+            t = t.resolve_self_param(id->self_type);
+
+          result = result.resolve_self_param(id->self_type);
+        }
+
+        // placeholders in free function refer to type of first argument.
+        // (ex: spawn(fn, ...) -> thread<result of fn>)
+        else if (!arg_types.empty()) {
+          result = result.resolve_self_param(arg_types[0]);
+        }
+
         auto res = this->check_function_call_parameters(call->args, fn->is_variable_args,
-                                                        fn->arg_types, arg_types, false);
+                                                        formal, arg_types, false);
 
         if (res.result == ArgumentCheckResult::Ok) {
           call->callee_builtin = fn;
 
+          // arguments and result are passed between threads
+          if (fn->name == "spawn") {
+            for (size_t i = 1; i < arg_types.size(); i++)
+              this->check_sendable(call->args[i], arg_types[i]);
+
+            if (!result.params.empty())
+              this->check_sendable(call->args[0], result.params[0]);
+          }
+
           if (functor->kind == ASTKind::BuiltinMemberFunction)
             call->args.insert(call->args.begin(), functor->as_expr()->lhs);
 
-          return fn->result_type;
+          return result;
         }
       }
 
@@ -719,8 +822,39 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
     auto arr = this->eval_type(x->lhs);
 
     switch (arr.kind) {
-    case TypeKind::Vector:
-      return arr.params[0];
+    case TypeKind::Vector: {
+      if (auto index = this->eval_type(x->rhs); !index.equals(TypeKind::Int)) {
+        throw Error(x->rhs, "expected 'int' type expression as index, but found '" +
+                                index.to_string() + "'");
+      }
+
+      return arr->params[0];
+    }
+
+    case TypeKind::Dict: {
+      if (auto key = this->eval_type(x->rhs); !key.equals(arr->params[0])) {
+        throw Error(x->rhs, "expected '" + arr->params[0].to_string() +
+                                "' type expression as key, but found '" +
+                                key.to_string() + "'");
+      }
+
+      return arr->params[1];
+    }
+
+    // index must be a constant
+    case TypeKind::Tuple: {
+      if (!this->eval_type(x->rhs).equals(TypeKind::Int) ||
+          x->rhs->kind != ASTKind::Value) {
+        throw Error(x->rhs, "expected constant integer as index of tuple");
+      }
+
+      i64 index = x->rhs->as_value()->value->As<ObjPrimitive>()->vi;
+
+      if (index < 0 || index >= (i64)arr->params.size())
+        throw Error(x->rhs, "index out of range");
+
+      return arr->params[(size_t)index];
+    }
     }
 
     throw Error(x->op, "'" + arr.to_string() + "' type is not subscriptable");
@@ -783,7 +917,7 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
     }
 
     for (auto const& [self_type, func] : builtins::get_builtin_member_functions()) {
-      if (left_type.equals(self_type) && func.name == rhs_id->GetName()) {
+      if (is_builtin_self_type(left_type, self_type) && func.name == rhs_id->GetName()) {
         rhs_id->candidates_builtin.emplace_back(&func);
       }
     }
@@ -796,7 +930,7 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
 
     for (builtins::MemberVariable const& mvar :
          builtins::get_builtin_member_variables()) {
-      if (left_type.equals(mvar.self_type) && mvar.name == name) {
+      if (is_builtin_self_type(left_type, mvar.self_type) && mvar.name == name) {
         expr->kind = ASTKind::BuiltinMemberVariable;
         rhs_id->blt_member_var = &mvar;
         return mvar.result_type;
@@ -842,6 +976,17 @@ TypeInfo Sema::eval_type(ASTPointer ast) {
     return type;
   }
 
+  case Kind::Await: {
+    auto x = ASTCast<AST::Expr>(ast);
+
+    auto type = this->eval_type(x->lhs);
+
+    if (type.kind != TypeKind::Future)
+      throw Error(x->lhs, "expected future, but found '" + type.to_string() + "'");
+
+    return type->params[0];
+  }
+
   case Kind::Assign: {
     auto x = ASTCast<AST::Expr>(ast);
 
@@ -2,7 +2,7 @@
 
 namespace fire::semantics_checker {
 
-TypeInfo Sema::EvalExpr(ASTPtr<AST::Expr> ast) {
+TypeId Sema::EvalExpr(ASTPtr<AST::Expr> ast) {
   using Kind = ASTKind;
   using TK = TypeKind;
 
@@ -33,7 +33,7 @@ TypeInfo Sema::EvalExpr(ASTPtr<AST::Expr> ast) {
 
   case Kind::Bigger:
   case Kind::BiggerOrEqual:
-    if (is_same && lhs.is_numeric_or_char() && rhs.is_numeric_or_char())
+    if (is_same && lhs->is_numeric_or_char() && rhs->is_numeric_or_char())
       return TK::Bool;
 
     break;
@@ -62,18 +62,29 @@ TypeInfo Sema::EvalExpr(ASTPtr<AST::Expr> ast) {
   switch (ast->kind) {
   case Kind::Add:
     //
-    // vector + T
-    // T + vector
+    // vector<T> + vector<T>
+    //  --> concatenate
+    if (is_same && lhs.kind == TK::Vector) {
+      ast->is_concat = true;
+      return lhs;
+    }
+
+    //
+    // vector<T> + T
+    // T + vector<T>
     //  --> append element to vector
-    if (lhs.kind == TK::Vector || rhs.kind == TK::Vector)
-      return TK::Vector;
+    if (lhs.kind == TK::Vector && (lhs->params.empty() || lhs->params[0].equals(rhs)))
+      return lhs;
+
+    if (rhs.kind == TK::Vector && (rhs->params.empty() || rhs->params[0].equals(lhs)))
+      return rhs;
 
     //
     // char + char  <--  Invalid
     // char + str
     // str  + char
     // str  + str
-    if (lhs.is_char_or_str() && rhs.is_char_or_str())
+    if (lhs->is_char_or_str() && rhs->is_char_or_str())
       return TK::String;
 
     break;
@@ -83,15 +94,15 @@ TypeInfo Sema::EvalExpr(ASTPtr<AST::Expr> ast) {
     // int * str
     // str * int
     //  => str
-    if (!is_same && lhs.is_hit_kind({TK::Int, TK::String}) &&
-        rhs.is_hit_kind({TK::Int, TK::String}))
+    if (!is_same && lhs->is_hit_kind({TK::Int, TK::String}) &&
+        rhs->is_hit_kind({TK::Int, TK::String}))
       return TK::String;
 
     // vector * int
     // int * vector
     //  => vector
-    if (!is_same && lhs.is_hit_kind({TK::Int, TK::Vector}) &&
-        rhs.is_hit_kind({TK::Int, TK::Vector}))
+    if (!is_same && lhs->is_hit_kind({TK::Int, TK::Vector}) &&
+        rhs->is_hit_kind({TK::Int, TK::Vector}))
       return TK::Vector;
 
     break;
@@ -0,0 +1,167 @@
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "alert.h"
+#include "Error.h"
+#include "Sema/Sema.h"
+
+#include "ASTWalker.h"
+
+namespace fire::semantics_checker {
+
+using NameSet =
+    HashMap<string_view, bool, std::hash<string_view>, std::equal_to<string_view>>;
+
+//
+// names which a function at top level cannot refer to, to be checked on
+// other thread.
+//
+//  - variables at top level or in namespace
+//      (types of them are deducted when check() reaches them)
+//  - template functions
+//      (body of template is checked again with parameters of each call)
+//  - classes which have member variable without type
+//      (initializer is evaluated when constructor is called)
+//
+static void collect_shared_names(ASTPtr<AST::Block> block, NameSet& out) {
+  for (auto&& e : block->list) {
+    switch (e->kind) {
+    case ASTKind::Vardef: {
+      auto x = e->As<AST::VarDef>();
+
+      out[x->GetName()] = true;
+
+      for (auto&& u : x->unpack)
+        out[u->GetName()] = true;
+
+      break;
+    }
+
+    case ASTKind::Function:
+      if (auto x = e->As<AST::Function>(); x->is_templated)
+        out[x->GetName()] = true;
+
+      break;
+
+    case ASTKind::Class: {
+      auto x = e->As<AST::Class>();
+
+      for (auto&& mv : x->member_variables)
+        if (!mv->type)
+          out[x->GetName()] = true;
+
+      for (auto&& mf : x->member_functions)
+        if (mf->is_templated)
+          out[mf->GetName()] = true;
+
+      break;
+    }
+
+    case ASTKind::Namespace:
+      collect_shared_names(ASTCast<AST::Block>(e), out);
+      break;
+    }
+  }
+}
+
+static bool refers_to(ASTPtr<AST::Function> func, NameSet const& names) {
+  bool found = false;
+
+  AST::walk_ast(func, [&](AST::ASTWalkerLocation loc, ASTPointer x) {
+    if (loc == AST::AW_Begin && !found &&
+        (x->kind == ASTKind::Identifier || x->kind == ASTKind::TypeName))
+      found = names.contains(x->As<AST::Named>()->GetName());
+  });
+
+  return found;
+}
+
+//
+// check_functions_parallel
+//
+//  bodies of functions at top level are checked on threads before check()
+//  of whole program.
+//
+//  types of arguments and result of functions are always written, so
+//  checking a body doesn't need other bodies checked. body depends on
+//  others only by names in collect_shared_names(), and functions which
+//  refer to them are checked by check() in order of program.
+//
+//  each thread has a worker Sema sharing scopes with this. (scopes of
+//  different functions are not shared, and tables of top level scopes are
+//  made before threads start)
+//
+//  errors are kept in checked_functions, and thrown when check() reaches
+//  the function. so first error in order of program is reported, same as
+//  checking without threads.
+//
+void Sema::check_functions_parallel(size_t jobs) {
+  NameSet shared;
+
+  collect_shared_names(this->root, shared);
+
+  ASTVec<AST::Function> funcs;
+
+  for (auto&& e : this->root->list) {
+    if (e->kind != ASTKind::Function)
+      continue;
+
+    auto func = ASTCast<AST::Function>(e);
+
+    if (!func->is_templated && !func->member_of && !refers_to(func, shared))
+      funcs.emplace_back(func);
+  }
+
+  if (funcs.size() < 2)
+    return;
+
+  this->_scope_context->make_symbols();
+  ((BlockScope*)this->GetScopeOf(this->root))->make_symbols();
+
+  vector<CheckedFunction> results(funcs.size());
+
+  std::atomic<size_t> next = 0;
+  std::mutex mtx;
+
+  auto run = [&] {
+    Sema worker{this};
+
+    for (size_t i; (i = next++) < funcs.size();) {
+      try {
+        worker.check(funcs[i]);
+      }
+      catch (...) {
+        results[i].error = std::current_exception();
+      }
+
+      results[i].parallel_for_list = std::move(worker.parallel_for_list);
+      worker.parallel_for_list.clear();
+
+      // scopes of function are left entered by error
+      worker.BackTo(worker.GetScopeOf(this->root));
+      worker.cur_function = nullptr;
+      worker._expected.clear();
+    }
+
+    std::lock_guard lock(mtx);
+
+    for (auto&& [id, info] : worker._identifier_info_keep)
+      this->_identifier_info_keep.try_emplace(id, std::move(info));
+  };
+
+  vector<std::thread> threads;
+
+  for (size_t i = 1; i < std::min(jobs, funcs.size()); i++)
+    threads.emplace_back(run);
+
+  run();
+
+  for (auto&& t : threads)
+    t.join();
+
+  for (size_t i = 0; i < funcs.size(); i++)
+    this->checked_functions.try_emplace(funcs[i], std::move(results[i]));
+}
+
+} // namespace fire::semantics_checker
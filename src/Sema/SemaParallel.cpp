@@ -0,0 +1,420 @@
+#include "alert.h"
+#include "Error.h"
+#include "Sema/Sema.h"
+#include "Builtin.h"
+
+#include "ASTWalker.h"
+
+namespace fire::semantics_checker {
+
+//
+// ParallelChecker
+//
+//  iterations of parallel for run on threads at same time, and objects
+//  declared out of the body are shared by them. (see Evaluator::parallel_for)
+//  so the body can write only:
+//
+//    - variables declared in the body, and the loop variable
+//    - reduction variable (each thread has own copy)
+//    - v[i], where v is a vector declared out of the body and i is the
+//      loop variable. other elements of v are written by other iterations,
+//      so v is used only as v[i] in the body.
+//
+//  elements and members can be written, and member functions can modify
+//  the object, only if it is created in the body. (see is_fresh)
+//
+//  called functions are checked in same way. (their locals are arguments
+//  and variables declared in them)
+//
+//  other vector may refer same object as v (let w = v;), so vectors out of
+//  the body which have same element type as v cannot be used with it,
+//  unless both are always new vectors. (see may_alias)
+//
+struct ParallelChecker {
+  using OuterVector = AST::Statement::ParallelFor::OuterVector;
+
+  AST::Statement::ParallelFor* d;
+
+  // vectors at top level (used in called functions)
+  vector<OuterVector> globals;
+
+  // names assigned from other than new object, in whole program
+  vector<string_view> reassigned;
+
+  // vectors written as v[i] in the body
+  vector<string_view> written;
+
+  ASTVec<AST::Function> checked;
+
+  struct Frame {
+    vector<string_view> locals;
+
+    // locals which are always a new object created in the body
+    vector<string_view> fresh;
+
+    bool is_body = false;
+  };
+
+  template <class T, class U>
+  static bool contains(vector<T> const& v, U const& x) {
+    return std::find(v.begin(), v.end(), x) != v.end();
+  }
+
+  static bool is_fresh_expr(ASTPointer ast) {
+    if (!ast)
+      return false;
+
+    switch (ast->kind) {
+    case ASTKind::Array:
+    case ASTKind::Tuple:
+    case ASTKind::Dict:
+    case ASTKind::CallFunc_Ctor:
+    case ASTKind::CallFunc_Enumerator:
+      return true;
+    }
+
+    return false;
+  }
+
+  bool is_fresh(Frame const& F, ASTPointer ast) {
+    return ast->kind == ASTKind::Variable && contains(F.fresh, ast->GetID()->GetName());
+  }
+
+  // builtin member functions which don't modify self
+  static bool is_const_member(string_view name) {
+    static char const* names[] = {"contains", "get", "keys", "length", "to_string"};
+
+    for (auto&& n : names)
+      if (name == n)
+        return true;
+
+    return false;
+  }
+
+  // builtin functions which cannot be called on threads of parallel for
+  static bool is_unsafe_builtin(string_view name) {
+    static char const* names[] = {"gc_collect",      "spawn",           "sleep_async",
+                                  "read_file_async", "write_file_async", "exec_async"};
+
+    for (auto&& n : names)
+      if (name == n)
+        return true;
+
+    return false;
+  }
+
+  Error make_error(ASTPointer ast, Frame const& F, std::string msg) {
+    if (F.is_body)
+      return Error(ast, msg + " in parallel for");
+
+    return Error(ast, msg + " in function called from parallel for");
+  }
+
+  // names assigned from other than new object (cannot be fresh)
+  static void find_aliased(ASTPointer block, vector<string_view>& out) {
+    AST::walk_ast(block, [&out](AST::ASTWalkerLocation loc, ASTPointer ast) {
+      if (loc != AST::AW_Begin || ast->kind != ASTKind::Assign)
+        return;
+
+      auto x = ast->as_expr();
+
+      // (Identifier: in template function, its body is not checked)
+      if ((x->lhs->kind == ASTKind::Variable || x->lhs->kind == ASTKind::Identifier) &&
+          !is_fresh_expr(x->rhs))
+        out.emplace_back(x->lhs->GetID()->GetName());
+    });
+  }
+
+  OuterVector const* find_outer(Frame const& F, string_view name) {
+    for (auto&& ov : F.is_body ? this->d->_outer_vectors : this->globals)
+      if (ov.name == name)
+        return &ov;
+
+    return nullptr;
+  }
+
+  // declared with new vector, and never assigned other.
+  bool is_distinct(OuterVector const& ov) {
+    return ov.decl && is_fresh_expr(ov.decl->init) && !contains(this->reassigned, ov.name);
+  }
+
+  // w may be same object as v
+  bool may_alias(OuterVector const& v, OuterVector const& w) {
+    if (this->is_distinct(v) && this->is_distinct(w))
+      return false;
+
+    if (v.type.params.empty() || w.type.params.empty())
+      return true;
+
+    return v.type.params[0].equals(w.type.params[0]);
+  }
+
+  // v in written, which may be same object as w (null if none)
+  string_view const* find_aliased_written(Frame const& F, OuterVector const& w) {
+    for (auto&& v : this->written) {
+      auto ov = this->find_outer(F, v);
+
+      if (!ov || this->may_alias(*ov, w))
+        return &v;
+    }
+
+    return nullptr;
+  }
+
+  void check_call(ASTPtr<AST::CallFunc> cf, Frame& F) {
+    auto callee = cf->callee;
+
+    if (cf->callee_builtin && is_unsafe_builtin(cf->callee_builtin->name))
+      throw make_error(cf, F, "cannot call '" + cf->callee_builtin->name + "'");
+
+    switch (callee->kind) {
+    case ASTKind::BuiltinMemberFunction: {
+      auto name = callee->GetID()->GetName();
+
+      if (!is_const_member(name) && !is_fresh(F, callee->as_expr()->lhs))
+        throw make_error(callee, F,
+                         "cannot call '" + string(name) +
+                             "' of object which is not created in this scope");
+
+      return;
+    }
+
+    case ASTKind::MemberFunction:
+      this->check_function(callee->GetID()->candidates[0], cf);
+      return;
+    }
+
+    if (cf->call_functor)
+      throw make_error(callee, F, "cannot call function object");
+
+    if (cf->callee_ast)
+      this->check_function(cf->callee_ast, cf);
+  }
+
+  // check write to left side of assignment
+  void check_write(ASTPtr<AST::Expr> assign, Frame& F, vector<ASTPointer>& allowed) {
+    auto lhs = assign->lhs;
+
+    switch (lhs->kind) {
+    case ASTKind::Variable: {
+      auto name = lhs->GetID()->GetName();
+
+      if (contains(F.locals, name))
+        return;
+
+      if (F.is_body && this->d->acc && name == this->d->acc->GetID()->GetName())
+        return;
+
+      throw make_error(lhs, F,
+                       "cannot write to variable '" + string(name) +
+                           "' declared out of scope");
+    }
+
+    case ASTKind::IndexRef: {
+      auto x = lhs->as_expr();
+
+      if (is_fresh(F, x->lhs))
+        return;
+
+      // v[i] = ...
+      if (F.is_body && x->lhs->kind == ASTKind::Variable &&
+          std::count(F.locals.begin(), F.locals.end(), this->d->varname.str) == 1 &&
+          x->rhs->kind == ASTKind::Variable &&
+          x->rhs->GetID()->GetName() == this->d->varname.str &&
+          !contains(F.locals, x->lhs->GetID()->GetName())) {
+        if (!contains(this->written, x->lhs->GetID()->GetName()))
+          this->written.emplace_back(x->lhs->GetID()->GetName());
+
+        allowed.emplace_back(x->lhs);
+        return;
+      }
+
+      break;
+    }
+
+    case ASTKind::MemberVariable:
+      if (is_fresh(F, lhs->as_expr()->lhs))
+        return;
+
+      break;
+    }
+
+    throw make_error(lhs, F,
+                     "cannot write to element or member of object which is not "
+                     "created in this scope");
+  }
+
+  void walk(ASTPointer ast, Frame& F) {
+    vector<std::pair<size_t, size_t>> marks; // sizes of locals and fresh
+
+    // v in v[i] (see check_write)
+    vector<ASTPointer> allowed;
+
+    auto aliased = vector<string_view>();
+
+    find_aliased(ast, aliased);
+
+    auto add_local = [&F, &aliased](string_view name, ASTPointer init) {
+      F.locals.emplace_back(name);
+
+      if (is_fresh_expr(init) && !contains(aliased, name))
+        F.fresh.emplace_back(name);
+    };
+
+    auto leave = [&F, &marks] {
+      F.locals.resize(marks.back().first);
+      F.fresh.resize(marks.back().second);
+      marks.pop_back();
+    };
+
+    AST::walk_ast(ast, [&](AST::ASTWalkerLocation loc, ASTPointer x) {
+      if (loc == AST::AW_End) {
+        switch (x->kind) {
+        case ASTKind::Block:
+        case ASTKind::ForEach:
+          leave();
+          break;
+
+        case ASTKind::Vardef: {
+          auto v = x->As<AST::VarDef>();
+
+          if (v->unpack.empty())
+            add_local(v->GetName(), v->init);
+          else
+            for (auto&& u : v->unpack)
+              add_local(u->GetName(), nullptr);
+
+          break;
+        }
+        }
+
+        return;
+      }
+
+      switch (x->kind) {
+      case ASTKind::Block:
+        marks.emplace_back(F.locals.size(), F.fresh.size());
+        break;
+
+      case ASTKind::ForEach:
+        marks.emplace_back(F.locals.size(), F.fresh.size());
+        add_local(x->as_stmt()->data_for_each->varname.str, nullptr);
+        break;
+
+      case ASTKind::ParallelFor:
+        throw make_error(x, F, "cannot use parallel for");
+
+      case ASTKind::Return:
+        if (F.is_body)
+          throw make_error(x, F, "cannot return");
+
+        break;
+
+      case ASTKind::Yield:
+        if (F.is_body)
+          throw make_error(x, F, "cannot yield");
+
+        break;
+
+      case ASTKind::Await:
+        throw make_error(x, F, "cannot await");
+
+      case ASTKind::Assign:
+        this->check_write(ASTCast<AST::Expr>(x), F, allowed);
+        break;
+
+      case ASTKind::CallFunc:
+        this->check_call(ASTCast<AST::CallFunc>(x), F);
+        break;
+
+      case ASTKind::Variable: {
+        auto name = x->GetID()->GetName();
+
+        if (contains(F.locals, name) || contains(allowed, x))
+          break;
+
+        if (contains(this->written, name)) {
+          // v[i] (as value)
+          throw make_error(x, F,
+                           "vector '" + string(name) + "' is written as '" + string(name) +
+                               "[" + string(this->d->varname.str) +
+                               "]', so it cannot be used in other way");
+        }
+
+        if (auto ov = this->find_outer(F, name); ov) {
+          if (auto v = this->find_aliased_written(F, *ov); v)
+            throw make_error(x, F,
+                             "vector '" + string(name) + "' may be same as '" + string(*v) +
+                                 "' written as '" + string(*v) + "[" +
+                                 string(this->d->varname.str) + "]'");
+        }
+
+        break;
+      }
+
+      case ASTKind::IndexRef: {
+        auto e = x->as_expr();
+
+        if (F.is_body && e->lhs->kind == ASTKind::Variable &&
+            e->rhs->kind == ASTKind::Variable &&
+            e->rhs->GetID()->GetName() == this->d->varname.str)
+          allowed.emplace_back(e->lhs);
+
+        break;
+      }
+      }
+    });
+  }
+
+  void check_function(ASTPtr<AST::Function> func, ASTPointer loc) {
+    if (contains(this->checked, func))
+      return;
+
+    this->checked.emplace_back(func);
+
+    if (func->is_async)
+      throw Error(loc, "cannot call async function in parallel for");
+
+    Frame F;
+
+    for (auto&& arg : func->arguments)
+      F.locals.emplace_back(arg->GetName());
+
+    this->walk(func->block, F);
+  }
+
+  void check_body() {
+    // first pass finds vectors written as v[i],
+    // and then second pass checks other uses of them.
+    for (int pass = 0; pass < 2; pass++) {
+      Frame F;
+
+      F.is_body = true;
+      F.locals.emplace_back(this->d->varname.str);
+
+      this->checked.clear();
+      this->walk(this->d->block, F);
+    }
+  }
+};
+
+//
+// called from check_full(), after all functions are checked.
+//
+void Sema::check_parallel_for(ASTPtr<AST::Statement> ast) {
+  auto d = ast->data_parallel_for;
+
+  ParallelChecker checker;
+
+  checker.d = d;
+
+  for (auto&& var : ((BlockScope*)this->GetScopeOf(this->root))->variables)
+    if (var.deducted_type.kind == TypeKind::Vector)
+      checker.globals.emplace_back(var.name, var.deducted_type, var.decl);
+
+  ParallelChecker::find_aliased(this->root, checker.reassigned);
+
+  checker.check_body();
+}
+
+} // namespace fire::semantics_checker
@@ -101,7 +101,19 @@ BlockScope::BlockScope(int depth, ASTPtr<AST::Block> ast, int index_add)
       break;
 
     case ASTKind::Vardef: {
-      auto& v = this->add_var(ASTCast<AST::VarDef>(e));
+      auto x = ASTCast<AST::VarDef>(e);
+
+      if (!x->unpack.empty()) {
+        for (auto&& y : x->unpack) {
+          auto& v = this->add_var(y);
+
+          y->index_add = v.index_add = index_add + this->child_var_count;
+        }
+
+        break;
+      }
+
+      auto& v = this->add_var(x);
 
       v.index_add = index_add + this->child_var_count;
 
@@ -186,6 +198,49 @@ BlockScope::BlockScope(int depth, ASTPtr<AST::Block> ast, int index_add)
       break;
     }
 
+    case ASTKind::ForEach: {
+      auto d = e->as_stmt()->data_for_each;
+
+      //
+      // for x in ... {   // var_scope (v-stack for 'x')
+      // }                //   block
+      //
+      auto var_scope = new BlockScope(this->depth + 1, nullptr);
+
+      var_scope->ast = d->block;
+
+      auto& var = var_scope->variables.emplace_back();
+
+      var.name = d->varname.str;
+      var.depth = var_scope->depth;
+
+      var_scope->AddScope(new BlockScope(this->depth + 2, d->block));
+
+      this->AddScope(var_scope);
+
+      break;
+    }
+
+    case ASTKind::ParallelFor: {
+      auto d = e->as_stmt()->data_parallel_for;
+
+      // same as for-each
+      auto var_scope = new BlockScope(this->depth + 1, nullptr);
+
+      var_scope->ast = d->block;
+
+      auto& var = var_scope->variables.emplace_back();
+
+      var.name = d->varname.str;
+      var.depth = var_scope->depth;
+
+      var_scope->AddScope(new BlockScope(this->depth + 2, d->block));
+
+      this->AddScope(var_scope);
+
+      break;
+    }
+
     case ASTKind::Switch:
       todo_impl;
 
@@ -334,6 +389,12 @@ ASTPointer BlockScope::GetAST() const {
 }
 
 ScopeContext::LocalVar* BlockScope::find_var(string_view const& name) {
+  if (this->has_symbols) {
+    auto sym = this->symbols.find(name);
+
+    return sym && sym->var != -1 ? &this->variables[sym->var] : nullptr;
+  }
+
   for (auto&& var : this->variables) {
     if (var.name == name)
       return &var;
@@ -342,6 +403,62 @@ ScopeContext::LocalVar* BlockScope::find_var(string_view const& name) {
   return nullptr;
 }
 
+BlockScope::Symbol const* BlockScope::get_symbol(string_view name) {
+  this->make_symbols();
+
+  return this->symbols.find(name);
+}
+
+//
+// make_symbols
+//
+//  first variable, enum, class and namespace of each name, and all functions
+//  of the name. (same as scanning variables and the block in order)
+//
+void BlockScope::make_symbols() {
+  if (this->has_symbols)
+    return;
+
+  this->has_symbols = true;
+
+  for (int i = 0; auto&& var : this->variables) {
+    if (auto& sym = this->symbols[var.name]; sym.var == -1)
+      sym.var = i;
+
+    i++;
+  }
+
+  if (!this->ast)
+    return;
+
+  for (auto&& e : this->ast->list) {
+    switch (e->kind) {
+    case ASTKind::Function:
+      this->symbols[e->As<AST::Function>()->GetName()].functions.emplace_back(
+          ASTCast<AST::Function>(e));
+      break;
+
+    case ASTKind::Enum:
+      if (auto& sym = this->symbols[e->As<AST::Named>()->GetName()]; !sym.ast_enum)
+        sym.ast_enum = ASTCast<AST::Enum>(e);
+
+      break;
+
+    case ASTKind::Class:
+      if (auto& sym = this->symbols[e->As<AST::Named>()->GetName()]; !sym.ast_class)
+        sym.ast_class = ASTCast<AST::Class>(e);
+
+      break;
+
+    case ASTKind::Namespace:
+      if (auto& sym = this->symbols[e->token.str]; !sym.ast_namespace)
+        sym.ast_namespace = ASTCast<AST::Block>(e);
+
+      break;
+    }
+  }
+}
+
 ScopeContext* BlockScope::find_child_scope(ASTPointer ast) {
   for (auto&& c : this->child_scopes) {
     if (c->GetAST() == ast)
@@ -405,17 +522,13 @@ FunctionScope::FunctionScope(int depth, ASTPtr<AST::Function> ast)
 
   auto S = Sema::GetInstance();
 
-  for (auto&& [_key, _val] : S->function_scope_map) {
-    if (_key == ast) {
-      todo_impl; // why again?
-    }
+  if (!S->function_scope_map.try_emplace(ast, this).second) {
+    todo_impl; // why again?
   }
 
   // auto f = Sema::SemaFunction(ast);
   // f.scope = this;
 
-  S->function_scope_map.emplace_back(ast, this);
-
   for (auto&& arg : ast->arguments) {
     this->add_arg(arg);
   }
@@ -458,6 +571,9 @@ ScopeContext* FunctionScope::find_child_scope(ASTPointer ast) {
   if (this->ast == ast)
     return this;
 
+  if (this->block->ast == ast)
+    return this->block;
+
   return this->block->find_child_scope(ast);
 }
 
@@ -67,6 +67,17 @@ Error Sema::TemplateTypeApplier::make_error(ASTPointer ast) {
   panic;
 }
 
+static bool contains_unknown(TypeInfo const& type) {
+  if (type.kind == TypeKind::Unknown)
+    return true;
+
+  for (auto&& p : type.params)
+    if (contains_unknown(p))
+      return true;
+
+  return false;
+}
+
 TypeInfo* Sema::find_template_parameter_name(string_view const& name) {
   for (auto&& pt : this->_applied_ptr_stack) {
     if (auto p = pt->find_parameter(name); p)
@@ -133,10 +144,26 @@ bool Sema::try_apply_template_function(TemplateTypeApplier& out,
   out.S = this;
   this->_applied_ptr_stack.push_front(&out);
 
-  if (!this->_find_applied(out)) {
+  if (out.instance = this->_find_applied(out); out.instance == -1) {
     debug(auto ii = this->_applied_ptr_stack.size());
 
-    this->_applied_templates.emplace_back(out).S = nullptr;
+    out.instance = (i64)this->_applied_templates.size();
+
+    this->_applied_templates.emplace_back().applied = out;
+    this->_applied_templates.back().applied.S = nullptr;
+
+    InstanceKey key{ast, {}};
+    bool has_unknown = false;
+
+    for (auto&& param : out.parameter_list) {
+      key.types.emplace_back(param.type);
+      has_unknown |= contains_unknown(param.type);
+    }
+
+    this->_applied_map.try_emplace(std::move(key), out.instance);
+
+    if (has_unknown)
+      this->_applied_unknown[ast].emplace_back(out.instance);
 
     ast->is_templated = false;
 
@@ -148,31 +175,76 @@ bool Sema::try_apply_template_function(TemplateTypeApplier& out,
 
     this->check(ast);
 
+    // signature of this instance
+    auto result_type = this->eval_type(ast->return_type);
+    TypeVec arg_types;
+
+    for (auto&& arg : ast->arguments)
+      arg_types.emplace_back(this->eval_type(arg->type));
+
     this->RestoreScopeLocation();
 
     ast->is_templated = true;
 
+    // (vector may be reallocated by instances made while checking)
+    auto& checked = this->_applied_templates[out.instance];
+
+    checked.checked = true;
+    checked.result_type = std::move(result_type);
+    checked.arg_types = std::move(arg_types);
+
     debug(assert(this->_applied_ptr_stack.size() == ii));
   }
 
   return true;
 }
 
-Sema::TemplateTypeApplier* Sema::_find_applied(TemplateTypeApplier const& t) {
-  for (auto&& x : this->_applied_templates) {
-    if (x.ast != t.ast || x.parameter_list.size() != t.parameter_list.size())
-      continue;
+//
+// _find_applied
+//
+//  same template with same types is found by hash.
+//  if Unknown type is in either of them, instances are compared by
+//  TypeInfo::equals() one by one. (Unknown matches any type)
+//
+i64 Sema::_find_applied(TemplateTypeApplier const& t) {
+  InstanceKey key{t.ast, {}};
+  bool has_unknown = false;
+
+  for (auto&& param : t.parameter_list) {
+    key.types.emplace_back(param.type);
+    has_unknown |= contains_unknown(param.type);
+  }
+
+  if (auto p = this->_applied_map.find(key); p)
+    return *p;
+
+  auto matches = [&t](TemplateTypeApplier const& x) {
+    if (x.parameter_list.size() != t.parameter_list.size())
+      return false;
 
     for (size_t i = 0; i < t.parameter_list.size(); i++) {
       if (!x.parameter_list[i].type.equals(t.parameter_list[i].type))
-        goto __skip;
+        return false;
     }
 
-    return &x;
-  __skip:;
+    return true;
+  };
+
+  if (has_unknown) {
+    for (i64 i = 0; auto&& x : this->_applied_templates) {
+      if (x.applied.ast == t.ast && matches(x.applied))
+        return i;
+
+      i++;
+    }
+  }
+  else if (auto v = this->_applied_unknown.find(t.ast); v) {
+    for (auto&& i : *v)
+      if (matches(this->_applied_templates[i].applied))
+        return i;
   }
 
-  return nullptr;
+  return -1;
 }
 
 } // namespace fire::semantics_checker
\ No newline at end of file
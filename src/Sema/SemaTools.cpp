@@ -11,8 +11,6 @@
 
 namespace fire::semantics_checker {
 
-std::vector<std::list<ScopeContext*>> _bak_list;
-
 TypeInfo Sema::eval_type_name(ASTPtr<AST::TypeName> ast) {
   auto& name = ast->GetName();
 
@@ -29,9 +27,34 @@ TypeInfo Sema::eval_type_name(ASTPtr<AST::TypeName> ast) {
   case TypeKind::Unknown:
     break;
 
-  default:
+  default: {
+    int count = type.needed_param_count();
+
+    for (auto&& param : ast->type_params)
+      type.params.emplace_back(this->eval_type_name(param));
+
+    if (!ast->type_params.empty() && count != -1 &&
+        count != (int)type.params.size()) {
+      throw Error(ast->token, "'" + string(name) + "' " +
+                                  (count == 0 ? "is not template type"
+                                              : "needs " + std::to_string(count) +
+                                                    " type parameters"));
+    }
+
+    if (type.kind == TypeKind::Dict && !type.params.empty() &&
+        !this->is_hashable(type.params[0])) {
+      throw Error(ast->type_params[0], "'" + type.params[0].to_string() +
+                                           "' type is not hashable");
+    }
+
+    if ((type.kind == TypeKind::Channel || type.kind == TypeKind::Thread) &&
+        !type.params.empty()) {
+      this->check_sendable(ast->type_params[0], type.params[0]);
+    }
+
     return type;
   }
+  }
 
   if (auto tp = this->find_template_parameter_name(name); tp)
     return *tp;
@@ -54,6 +77,106 @@ TypeInfo Sema::eval_type_name(ASTPtr<AST::TypeName> ast) {
   throw Error(ast->token, "unknown type name");
 }
 
+// member variables of class, or arguments of enumerators.
+static ASTVector member_types_of(TypeInfo const& type) {
+  ASTVector members;
+
+  if (type.kind == TypeKind::Instance) {
+    for (auto&& mv : ASTCast<AST::Class>(type.type_ast)->member_variables)
+      members.emplace_back(mv->type ? mv->type : mv->init);
+  }
+  else {
+    for (auto&& e : ASTCast<AST::Enum>(type.type_ast)->enumerators)
+      for (auto&& t : e.types)
+        members.emplace_back(t);
+  }
+
+  return members;
+}
+
+bool Sema::is_hashable(TypeInfo const& type) {
+  switch (type.kind) {
+  case TypeKind::Enumerator: {
+    auto& checking = this->_hashable_checking;
+
+    if (std::find(checking.begin(), checking.end(), type.type_ast) != checking.end())
+      return true;
+
+    checking.emplace_back(type.type_ast);
+
+    bool ok = true;
+
+    try {
+      for (auto&& m : member_types_of(type))
+        if (!(ok = this->is_hashable(this->eval_type(m))))
+          break;
+    }
+    catch (...) {
+      checking.pop_back();
+      throw;
+    }
+
+    checking.pop_back();
+
+    return ok;
+  }
+
+  case TypeKind::Tuple:
+    for (auto&& p : type.params)
+      if (!this->is_hashable(p))
+        return false;
+
+    return true;
+  }
+
+  return type.is_hashable();
+}
+
+bool Sema::is_sendable(TypeInfo const& type) {
+  switch (type.kind) {
+  case TypeKind::Generator:
+  case TypeKind::Future:
+    return false;
+
+  case TypeKind::Instance:
+  case TypeKind::Enumerator: {
+    auto& checking = this->_sendable_checking;
+
+    if (std::find(checking.begin(), checking.end(), type.type_ast) != checking.end())
+      return true;
+
+    checking.emplace_back(type.type_ast);
+
+    bool ok = true;
+
+    try {
+      for (auto&& m : member_types_of(type))
+        if (!(ok = this->is_sendable(this->eval_type(m))))
+          break;
+    }
+    catch (...) {
+      checking.pop_back();
+      throw;
+    }
+
+    checking.pop_back();
+
+    return ok;
+  }
+  }
+
+  for (auto&& p : type.params)
+    if (!this->is_sendable(p))
+      return false;
+
+  return true;
+}
+
+void Sema::check_sendable(ASTPointer ast, TypeInfo const& type) {
+  if (!this->is_sendable(type))
+    throw Error(ast, "'" + type.to_string() + "' type cannot be passed to other thread");
+}
+
 ScopeContext* Sema::GetRootScope() {
   return this->_scope_context;
 }
@@ -103,13 +226,13 @@ void Sema::LeaveScope() {
 
 void Sema::SaveScopeLocation() {
 
-  _bak_list.emplace_back(this->_scope_history);
+  this->_bak_list.emplace_back(this->_scope_history);
 }
 
 void Sema::RestoreScopeLocation() {
-  this->_scope_history = *_bak_list.rbegin();
+  this->_scope_history = *this->_bak_list.rbegin();
 
-  _bak_list.pop_back();
+  this->_bak_list.pop_back();
 }
 
 void Sema::BackToDepth(int depth) {
@@ -169,98 +292,70 @@ ScopeContext::LocalVar* Sema::_find_variable(string_view const& name) {
   return nullptr;
 }
 
-ASTVec<Function> Sema::_find_func(string_view const& name) {
-  ASTVec<AST::Function> v;
-
-  for (auto&& scope : this->GetHistory()) {
-    if (!scope->is_block)
-      continue;
-
-    for (auto&& e : ((BlockScope*)scope)->ast->list) {
-      if (auto f = ASTCast<AST::Function>(e);
-          f->kind == ASTKind::Function && f->GetName() == name)
-        v.emplace_back(f);
-    }
-  }
-
-  return v;
-}
-
-ASTPtr<Enum> Sema::_find_enum(string_view const& name) {
-  return ASTCast<AST::Enum>(this->context_reverse_search([&name](ASTPointer p) {
-    return p->kind == ASTKind::Enum && p->As<AST::Named>()->GetName() == name;
-  }));
-}
+//
+// find_name
+//
+//  looks up scopes from current to root (or current only) in one pass.
+//  blocks answer by their symbol table. (see BlockScope::get_symbol)
+//
+//  variable is found first. otherwise, functions of all scopes, or first
+//  enum, class, namespace found, in this order.
+//
+Sema::NameFindResult Sema::find_name(string_view const& name, bool const only_cur_scope) {
 
-ASTPtr<Class> Sema::_find_class(string_view const& name) {
-  return ASTCast<AST::Class>(this->context_reverse_search([&name](ASTPointer p) {
-    return p->kind == ASTKind::Class && p->As<AST::Named>()->GetName() == name;
-  }));
-}
+  NameFindResult result = {};
 
-ASTPtr<Block> Sema::_find_namespace(string_view const& name) {
-  return ASTCast<AST::Block>(this->context_reverse_search([&name](ASTPointer p) {
-    return p->kind == ASTKind::Namespace && p->token.str == name;
-  }));
-}
+  ASTPtr<AST::Enum> ast_enum = nullptr;
+  ASTPtr<AST::Class> ast_class = nullptr;
+  ASTPtr<AST::Block> ast_namespace = nullptr;
 
-ASTPointer Sema::context_reverse_search(std::function<bool(ASTPointer)> func) {
   for (auto&& scope : this->GetHistory()) {
-    if (!scope->is_block)
-      continue;
-
-    for (auto&& e : ((BlockScope*)scope)->ast->list) {
-      if (func(e))
-        return e;
+    if (!scope->is_block) {
+      if (!result.lvar)
+        result.lvar = scope->find_var(name);
     }
-  }
+    else if (auto sym = ((BlockScope*)scope)->get_symbol(name); sym) {
+      if (!result.lvar && sym->var != -1)
+        result.lvar = &((BlockScope*)scope)->variables[sym->var];
 
-  return nullptr;
-}
+      result.functions.insert(result.functions.end(), sym->functions.begin(),
+                              sym->functions.end());
 
-Sema::NameFindResult Sema::find_name(string_view const& name, bool const only_cur_scope) {
+      if (!ast_enum)
+        ast_enum = sym->ast_enum;
 
-  NameFindResult result = {};
+      if (!ast_class)
+        ast_class = sym->ast_class;
 
-  if (only_cur_scope) {
-    this->SaveScopeLocation();
-    this->GetHistory() = {this->GetCurScope()};
-  }
+      if (!ast_namespace)
+        ast_namespace = sym->ast_namespace;
+    }
 
-  result.lvar = this->_find_variable(name);
+    if (only_cur_scope)
+      break;
+  }
 
   if (result.lvar) {
     result.type = NameType::Var;
-
-    if (only_cur_scope) {
-      this->RestoreScopeLocation();
-    }
+    result.functions.clear();
 
     return result;
   }
 
-  result.functions = this->_find_func(name);
-
   if (result.functions.size() >= 1)
     result.type = NameType::Func;
 
-  else if ((result.ast_enum = this->_find_enum(name)))
+  else if ((result.ast_enum = ast_enum))
     result.type = NameType::Enum;
 
-  else if ((result.ast_class = this->_find_class(name)))
+  else if ((result.ast_class = ast_class))
     result.type = NameType::Class;
 
-  else if ((result.ast_namespace = this->_find_namespace(name)))
+  else if ((result.ast_namespace = ast_namespace))
     result.type = NameType::Namespace;
 
-  else {
-    // find builtin func
-    for (builtins::Function const& bfunc : builtins::get_builtin_functions()) {
-      if (bfunc.name == name) {
-        result.builtin_funcs.emplace_back(&bfunc);
-      }
-    }
-  }
+  else if (auto bfuncs = builtins::find_builtin_funcs(name); bfuncs)
+    result.builtin_funcs = *bfuncs;
 
   if (result.builtin_funcs.size() >= 1) {
     result.type = NameType::BuiltinFunc;
@@ -270,10 +365,6 @@ Sema::NameFindResult Sema::find_name(string_view const& name, bool const only_cu
     result.type = NameType::TypeName;
   }
 
-  if (only_cur_scope) {
-    this->RestoreScopeLocation();
-  }
-
   return result;
 }
 
@@ -426,6 +517,7 @@ bool Sema::IsWritable(ASTPointer ast) {
 
   case ASTKind::IndexRef:
   case ASTKind::MemberAccess:
+  case ASTKind::MemberVariable:
     return this->IsWritable(ASTCast<AST::Expr>(ast)->lhs);
   }
 
@@ -435,7 +527,11 @@ bool Sema::IsWritable(ASTPointer ast) {
 TypeInfo Sema::ExpectType(TypeInfo const& type, ASTPointer ast) {
   this->_expected.emplace_back(type);
 
-  if (auto t = this->eval_type(ast); !t.equals(type)) {
+  auto t = this->eval_type(ast);
+
+  this->_expected.pop_back();
+
+  if (!t.equals(type)) {
     throw Error(ast, "expected '" + type.to_string() + "' type expression, but found '" +
                          t.to_string() + "'");
   }
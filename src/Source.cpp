@@ -1,20 +1,45 @@
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "alert.h"
 #include "Parser.h"
 
 namespace fire {
 
+SourceStorage::LineRange SourceStorage::GetLine(i64 index) const {
+  auto begin = (i64)this->line_begins[index];
+  auto end = (i64)this->data.length();
+
+  // exclude '\n'
+  if (index + 1 < this->Count())
+    end = this->line_begins[index + 1] - 1;
+  else if (end > begin && this->data[end - 1] == '\n')
+    end--;
+
+  return LineRange(index, begin, end);
+}
+
+//
+// line which has position. (binary search in line_begins)
+//
 SourceStorage::LineRange SourceStorage::GetLineRange(i64 position) const {
-  for (auto&& line : this->line_range_list) {
-    if (line.begin <= position && position <= line.end)
-      return line;
-  }
+  if (position < 0 || position > (i64)this->data.length())
+    throw std::out_of_range("GetLineRange()");
+
+  auto it = std::upper_bound(this->line_begins.begin(), this->line_begins.end(), position);
 
-  throw std::out_of_range("GetLineRange()");
+  return this->GetLine(it - this->line_begins.begin() - 1);
 }
 
 std::string_view SourceStorage::GetLineView(LineRange const& line) const {
-  return std::string_view(this->data.c_str() + line.begin, line.length);
+  return this->data.substr(line.begin, line.length);
 }
 
 std::vector<SourceStorage::LineRange>
@@ -27,37 +52,114 @@ SourceStorage::GetLinesOfAST(ASTPointer ast) {
   return lines;
 }
 
+//
+// Open
+//
+//  maps the file in place. (no copy of source)
+//  an anonymous page follows the mapping, so data is terminated by '\0'
+//  even if size of file is a multiple of page size.
+//
 bool SourceStorage::Open() {
-  this->file = std::make_unique<std::ifstream>(this->path);
+  int fd = open(this->path.c_str(), O_RDONLY);
 
-  if (this->file->fail())
+  if (fd < 0)
     return false;
 
-  i64 pos = 0;
+  struct stat st;
 
-  for (std::string line; std::getline(*this->file, line);) {
-    this->line_range_list.emplace_back(this->line_range_list.size(), pos,
-                                       pos + line.length());
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return false;
+  }
 
-    this->data += line + '\n';
-    pos += line.length() + 1;
+  // offsets are 32-bit. (see SourceLocation)
+  if (S_ISREG(st.st_mode) && st.st_size > (off_t)UINT32_MAX) {
+    close(fd);
+    return false;
   }
 
-  this->data += "\n";
+  if (S_ISREG(st.st_mode)) {
+    auto page = (size_t)sysconf(_SC_PAGESIZE);
+    auto size = (size_t)st.st_size;
+    auto total = (size + 1 + page - 1) / page * page;
+
+    auto p = mmap(nullptr, total, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 
-  if (this->line_range_list.empty()) {
-    this->line_range_list.emplace_back(0, 0, 0);
+    if (p != MAP_FAILED && size != 0 &&
+        mmap(p, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      munmap(p, total);
+      p = MAP_FAILED;
+    }
+
+    if (p != MAP_FAILED) {
+      this->mapped = p;
+      this->mapped_size = total;
+      this->data = std::string_view((char const*)p, size);
+    }
   }
 
+  // not a regular file, or failed to map
+  if (!this->mapped) {
+    char buf[1 << 16];
+
+    for (ssize_t n; (n = read(fd, buf, sizeof(buf))) > 0;)
+      this->buffer.append(buf, (size_t)n);
+
+    this->data = this->buffer;
+  }
+
+  close(fd);
+
+  this->make_line_table();
+
   return true;
 }
 
 bool SourceStorage::IsOpen() const {
-  return file && file->is_open();
+  return this->data.data() != nullptr;
+}
+
+//
+// make_line_table
+//
+//  finds all '\n' in one pass. (16 bytes at once with SSE2)
+//
+void SourceStorage::make_line_table() {
+  auto const s = this->data.data();
+  auto const size = (i64)this->data.length();
+
+  this->line_begins.emplace_back(0);
+
+  i64 i = 0;
+
+#if defined(__SSE2__)
+  auto const nl = _mm_set1_epi8('\n');
+
+  for (; i + 16 <= size; i += 16) {
+    auto m = (u32)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i)), nl));
+
+    for (; m; m &= m - 1)
+      this->line_begins.emplace_back((u32)(i + __builtin_ctz(m) + 1));
+  }
+#endif
+
+  for (; i < size; i++)
+    if (s[i] == '\n')
+      this->line_begins.emplace_back((u32)(i + 1));
+
+  // no line after last '\n'
+  if (this->line_begins.size() >= 2 && this->line_begins.back() == size)
+    this->line_begins.pop_back();
 }
 
 SourceStorage::SourceStorage(std::string path)
     : path(path) {
 }
 
+SourceStorage::~SourceStorage() {
+  if (this->mapped)
+    munmap(this->mapped, this->mapped_size);
+}
+
 } // namespace fire
\ No newline at end of file
@@ -3,7 +3,7 @@
 namespace fire {
 
 Token const* Token::get_prev(int step) {
-  if (this->_index - step < 0)
+  if ((i64)this->_index - step < 0)
     return nullptr;
 
   return &this->sourceloc.ref->token_list[this->_index - step];
@@ -1,10 +1,13 @@
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <cassert>
 
 #include "alert.h"
 #include "Utils.h"
 #include "TypeInfo.h"
 #include "AST.h"
+#include "HashMap.h"
 
 namespace fire {
 
@@ -23,6 +26,11 @@ static char const* g_names[] = {
   "tuple",
   "dict",
 
+  "thread",
+  "channel",
+  "future",
+  "generator",
+
   "", // Enumerator
   "", // Instance
 
@@ -45,6 +53,10 @@ static std::map<TypeKind, char const*> kind_name_map {
   { TypeKind::Vector,     "vector" },
   { TypeKind::Tuple,      "tuple" },
   { TypeKind::Dict,       "dict" },
+  { TypeKind::Thread,     "thread" },
+  { TypeKind::Channel,    "channel" },
+  { TypeKind::Future,     "future" },
+  { TypeKind::Generator,  "generator" },
   { TypeKind::Instance,   "instance" },
   { TypeKind::Module,     "module" },
   { TypeKind::Function,   "function" },
@@ -123,7 +135,7 @@ bool TypeInfo::equals(TypeInfo const& type) const {
   }
 
   for (auto it = this->params.begin(); auto&& t : type.params)
-    if (!it->equals(t))
+    if (!(it++)->equals(t))
       return false;
 
   return true;
@@ -198,6 +210,10 @@ TypeInfo TypeInfo::without_params() const {
 int TypeInfo::needed_param_count() const {
   switch (this->kind) {
   case TypeKind::Vector:
+  case TypeKind::Thread:
+  case TypeKind::Channel:
+  case TypeKind::Future:
+  case TypeKind::Generator:
     return 1;
 
   case TypeKind::Function:
@@ -228,6 +244,49 @@ bool TypeInfo::is_iterable() const {
   return false;
 }
 
+bool TypeInfo::is_hashable() const {
+  switch (this->kind) {
+  case TypeKind::Int:
+  case TypeKind::Bool:
+  case TypeKind::Char:
+  case TypeKind::String:
+  case TypeKind::Enumerator:
+    return true;
+
+  case TypeKind::Tuple:
+    for (auto&& p : this->params)
+      if (!p.is_hashable())
+        return false;
+
+    return true;
+  }
+
+  return false;
+}
+
+TypeInfo TypeInfo::make_self_param(int index) {
+  TypeInfo t = TypeKind::Unknown;
+
+  t.name = "$" + std::to_string(index);
+
+  return t;
+}
+
+TypeInfo TypeInfo::resolve_self_param(TypeInfo const& self) const {
+  if (this->kind == TypeKind::Unknown && this->name.starts_with('$')) {
+    size_t index = std::stoul(this->name.substr(1));
+
+    return index < self.params.size() ? self.params[index] : *this;
+  }
+
+  auto copy = *this;
+
+  for (auto&& p : copy.params)
+    p = p.resolve_self_param(self);
+
+  return copy;
+}
+
 TypeInfo TypeInfo::from_enum(ASTPtr<AST::Enum> ast) {
   TypeInfo t = TypeKind::TypeName;
 
@@ -254,9 +313,9 @@ TypeInfo TypeInfo::make_instance_type(ASTPtr<AST::Class> ast) {
   return ret;
 }
 
-TypeKind TypeInfo::from_name(string const& name) {
+TypeKind TypeInfo::from_name(string_view name) {
   for (int i = 0; auto& s : g_names) {
-    if (s == name)
+    if (name == s)
       return static_cast<TypeKind>(i);
 
     i++;
@@ -274,4 +333,160 @@ TypeInfo::TypeInfo(TypeKind kind, std::vector<TypeInfo> params)
       params(std::move(params)) {
 }
 
-} // namespace fire
\ No newline at end of file
+// ----------------------------
+//  type table
+
+namespace {
+
+// type_ast of type or its params is in arena.
+bool refers_to(TypeInfo const& t, AST::Arena const& arena) {
+  if (t.type_ast && arena.contains(t.type_ast))
+    return true;
+
+  for (auto&& p : t.params)
+    if (refers_to(p, arena))
+      return true;
+
+  return false;
+}
+
+// compare all fields. (not equals(), Unknown is not wildcard here)
+bool is_same_type(TypeInfo const& a, TypeInfo const& b) {
+  if (a.kind != b.kind || a.is_const != b.is_const || a.name != b.name ||
+      a.type_ast != b.type_ast || a.enum_index != b.enum_index ||
+      a.is_free_args != b.is_free_args || a.is_member_func != b.is_member_func ||
+      a.params.size() != b.params.size())
+    return false;
+
+  for (size_t i = 0; i < a.params.size(); i++)
+    if (!is_same_type(a.params[i], b.params[i]))
+      return false;
+
+  return true;
+}
+
+size_t hash_type(TypeInfo const& t) {
+  size_t h = hash_combine(static_cast<size_t>(t.kind),
+                          reinterpret_cast<size_t>(t.type_ast));
+
+  h = hash_combine(h, t.enum_index);
+
+  for (auto&& p : t.params)
+    h = hash_combine(h, hash_type(p));
+
+  return h;
+}
+
+struct TypeHash {
+  size_t operator()(TypeInfo const& t) const {
+    return hash_type(t);
+  }
+};
+
+struct TypeSame {
+  bool operator()(TypeInfo const& a, TypeInfo const& b) const {
+    return is_same_type(a, b);
+  }
+};
+
+//
+// types are stored in fixed size chunks, never moved.
+// so get() needs no lock while other thread is interning.
+//
+// most of intern() are hits, so lookup takes shared lock. (Sema interns
+// results of eval_type, on threads of --jobs)
+//
+struct TypeTable {
+  static constexpr size_t ChunkBits = 10;
+  static constexpr size_t ChunkSize = 1 << ChunkBits;
+  static constexpr size_t MaxChunks = 4096;
+
+  static constexpr u32 KindCount = static_cast<u32>(TypeKind::Unknown) + 1;
+
+  std::shared_mutex mtx;
+
+  TypeInfo* chunks[MaxChunks] = {};
+  size_t count = 0;
+
+  HashMap<TypeInfo, u32, TypeHash, TypeSame> map;
+
+  TypeInfo& at(u32 index) const {
+    return this->chunks[index >> ChunkBits][index & (ChunkSize - 1)];
+  }
+
+  u32 add(TypeInfo const& type) {
+    if (this->count == MaxChunks * ChunkSize)
+      panic;
+
+    if ((this->count & (ChunkSize - 1)) == 0)
+      this->chunks[this->count >> ChunkBits] = new TypeInfo[ChunkSize];
+
+    auto index = static_cast<u32>(this->count++);
+
+    this->at(index) = type;
+    this->map.try_emplace(type, index);
+
+    return index;
+  }
+
+  u32 intern(TypeInfo const& type) {
+    {
+      std::shared_lock lock(this->mtx);
+
+      if (auto p = this->map.find(type); p)
+        return *p;
+    }
+
+    std::unique_lock lock(this->mtx);
+
+    // added by other thread while unlocked
+    if (auto p = this->map.find(type); p)
+      return *p;
+
+    return this->add(type);
+  }
+
+  // indices are not reused, so stale handle never means other type.
+  void forget(AST::Arena const& arena) {
+    std::unique_lock lock(this->mtx);
+
+    for (u32 i = KindCount; i < this->count; i++) {
+      if (auto& t = this->at(i); refers_to(t, arena)) {
+        this->map.erase(t);
+        t = TypeInfo();
+      }
+    }
+  }
+
+  TypeTable() {
+    // index of TypeInfo(kind) is same as kind. (see TypeId(TypeKind))
+    for (u32 k = 0; k < KindCount; k++)
+      this->add(TypeInfo(static_cast<TypeKind>(k)));
+  }
+};
+
+TypeTable& get_table() {
+  static TypeTable table;
+  return table;
+}
+
+} // namespace
+
+TypeId::TypeId(TypeInfo const& type)
+    : kind(type.kind),
+      index(get_table().intern(type)) {
+}
+
+TypeInfo const& TypeId::get() const {
+  return get_table().at(this->index);
+}
+
+size_t TypeId::count() {
+  return get_table().count;
+}
+
+void TypeId::forget(AST::Arena const& arena) {
+  get_table().forget(arena);
+}
+
+} // namespace fire
@@ -2,8 +2,9 @@
 
 namespace utils {
 
-static std::wstring_convert<std::codecvt_utf8_utf16<char16_t>,
-                            char16_t>
+// converter keeps state of last conversion, so each thread has own one.
+// (strings are made by front-end of scripts and evaluators on other threads)
+static thread_local std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>
     conv;
 
 std::string remove_color(std::string str) {
@@ -1,4 +1,9 @@
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 #include "alert.h"
 
@@ -10,6 +15,10 @@
 #include "Parser.h"
 #include "Sema/Sema.h"
 #include "Evaluator.h"
+#include "Cache.h"
+#include "GC.h"
+#include "Allocator.h"
+#include "EventLoop.h"
 
 static constexpr auto command_help = R"(
 usage: flame [options] scripts...
@@ -17,10 +26,18 @@ usage: flame [options] scripts...
 options:
     -h --help         show this information
     -v --version      show version info
+
+    --gc-threshold N  run gc after N container objects are allocated
+    --gc-stats        print gc statistics at exit
+    --no-gc           disable gc (reference counting only)
+    --alloc-stats     print object allocator statistics at exit
+    --parse-stats     print time of lexing and parsing, and tokens per second
+    --no-cache        don't load or save checked program in cache directory
+    --jobs N          check functions of program on N threads
 )";
 
 static constexpr auto command_version = R"(
-fire 0.0.1
+fire )" FIRE_VERSION R"(
 )";
 
 struct CmdLineArguments {
@@ -31,6 +48,18 @@ struct CmdLineArguments {
   // -v, --version
   bool version_info = false;
 
+  // --alloc-stats
+  bool alloc_stats = false;
+
+  // --parse-stats
+  bool parse_stats = false;
+
+  // --no-cache
+  bool no_cache = false;
+
+  // --jobs N
+  size_t jobs = 1;
+
   //
   // [source files]
   StringVector sources;
@@ -47,6 +76,35 @@ int parse_command_line(CmdLineArguments& cmd, int argc, char** argv) {
     else if (arg == "-v" || arg == "--version")
       cmd.version_info = true;
 
+    else if (arg == "--gc-threshold") {
+      if (argc-- == 0)
+        fire::Error::fatal_error("expected number after '--gc-threshold'");
+
+      fire::gc::set_threshold(std::max(1, atoi(*argv++)));
+    }
+
+    else if (arg == "--gc-stats")
+      fire::gc::get_config().print_stats = true;
+
+    else if (arg == "--no-gc")
+      fire::gc::get_config().enabled = false;
+
+    else if (arg == "--alloc-stats")
+      cmd.alloc_stats = true;
+
+    else if (arg == "--parse-stats")
+      cmd.parse_stats = true;
+
+    else if (arg == "--no-cache")
+      cmd.no_cache = true;
+
+    else if (arg == "--jobs") {
+      if (argc-- == 0)
+        fire::Error::fatal_error("expected number after '--jobs'");
+
+      cmd.jobs = (size_t)std::max(1, atoi(*argv++));
+    }
+
     else
       cmd.sources.emplace_back(std::move(arg));
   }
@@ -54,35 +112,167 @@ int parse_command_line(CmdLineArguments& cmd, int argc, char** argv) {
   return 0;
 }
 
-void execute_file(std::string const& path) {
+static void print_parse_stats(std::ostream& out, std::string const& path, size_t tokens,
+                              double lex_ms, double parse_ms) {
+  out << "parse: " << path << std::endl
+      << "parse: tokens    = " << tokens << std::endl
+      << "parse: lex       = " << lex_ms << " ms (" << (size_t)(tokens / (lex_ms / 1000))
+      << " tokens/s)" << std::endl
+      << "parse: parse     = " << parse_ms << " ms ("
+      << (size_t)(tokens / (parse_ms / 1000)) << " tokens/s)" << std::endl;
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point begin) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+//
+// lex, parse and check source.
+// returns null if source has no token.
+//
+static fire::ASTPtr<fire::AST::Block> compile(fire::SourceStorage& source,
+                                              CmdLineArguments const& cmd,
+                                              std::ostream& stats) {
   using namespace fire;
 
-  try {
+  auto lex_begin = Clock::now();
 
-    SourceStorage source{path};
+  Lexer lexer{source};
 
-    if (!source.Open()) {
-      Error::fatal_error("cannot open file '" + path + "'");
-    }
+  lexer.Lex(source.token_list);
+
+  auto lex_ms = elapsed_ms(lex_begin);
+
+  if (source.token_list.empty())
+    return nullptr;
+
+  auto parse_begin = Clock::now();
+
+  parser::Parser parser{source.token_list};
+
+  ASTPtr<AST::Block> prg = parser.Parse();
+
+  if (cmd.parse_stats)
+    print_parse_stats(stats, source.path, source.token_list.size(), lex_ms,
+                      elapsed_ms(parse_begin));
+
+  semantics_checker::Sema sema{prg};
+
+  sema.check_full(cmd.jobs);
+
+  return prg;
+}
+
+//
+// Script
+//
+//  a script given in command line.
+//
+//  front-end (lex, parse and Sema, or loading from cache) of all scripts
+//  runs on threads at same time, and main thread evaluates them in order
+//  of command line. (see run_scripts)
+//
+//  nothing is printed by front-end. errors and statistics are kept here,
+//  and printed by main thread when it reaches this script.
+//
+struct Script {
+  // lives until error is emitted. (errors refer to tokens in source)
+  fire::SourceStorage source;
+
+  // tokens loaded from cache may refer to the mapped file.
+  fire::ProgramCache cache{source};
+
+  // all AST nodes of this script, freed after evaluation.
+  fire::AST::Arena arena;
+
+  fire::ASTPtr<fire::AST::Block> prg = nullptr;
+
+  bool opened = false;
+
+  std::exception_ptr error = nullptr;
+
+  // --parse-stats
+  std::ostringstream stats;
+
+  // objects made by front-end on other thread. (constants in AST)
+  std::vector<fire::Object*> objects;
+
+  std::promise<void> ready;
+
+  explicit Script(std::string const& path)
+      : source(path) {
+  }
+};
 
-    Lexer lexer{source};
+static void front_end(Script& script, CmdLineArguments const& cmd) {
+  using namespace fire;
 
-    lexer.Lex(source.token_list);
+  AST::Arena::Scope arena_scope{script.arena};
 
-    if (source.token_list.empty())
+  try {
+    if (!(script.opened = script.source.Open()))
       return;
 
-    parser::Parser parser{source.token_list};
+    if (!cmd.no_cache) {
+      auto load_begin = Clock::now();
+
+      script.prg = script.cache.Load();
+
+      if (script.prg && cmd.parse_stats) {
+        script.stats << "parse: " << script.source.path << std::endl
+                     << "parse: loaded    = " << script.cache.GetPath() << " ("
+                     << elapsed_ms(load_begin) << " ms)" << std::endl;
+      }
+    }
+
+    if (!script.prg) {
+      script.prg = compile(script.source, cmd, script.stats);
+
+      if (script.prg && !cmd.no_cache)
+        script.cache.Save(script.prg);
+    }
+  }
+  catch (...) {
+    script.error = std::current_exception();
+  }
+}
+
+// returns false if the file cannot be opened.
+static bool execute_script(Script& script) {
+  using namespace fire;
 
-    ASTPtr<AST::Block> prg = parser.Parse();
+  for (auto&& obj : script.objects)
+    gc::adopt(obj);
 
-    semantics_checker::Sema sema{prg};
+  if (!script.opened)
+    return false;
 
-    sema.check_full();
+  AST::Arena::Scope arena_scope{script.arena};
 
-    eval::Evaluator ev;
+  std::cerr << script.stats.str();
 
-    ev.evaluate(prg);
+  try {
+    if (script.error)
+      std::rethrow_exception(script.error);
+
+    if (script.prg) {
+      eval::Evaluator ev;
+
+      // async calls refer to ev, so they don't remain after this script.
+      try {
+        ev.evaluate(script.prg);
+
+        // not awaited yet
+        while (io::EventLoop::get().run_once())
+          ;
+      }
+      catch (...) {
+        io::EventLoop::get().cancel_all();
+        throw;
+      }
+    }
   }
 
   catch (Error const& err) {
@@ -93,6 +283,71 @@ void execute_file(std::string const& path) {
     Error::fatal_error("throwed unhandled exception object of '" + obj->type.to_string() +
                        "'");
   }
+
+  // instances in garbage cycles refer to their class in arena.
+  gc::collect();
+
+  return true;
+}
+
+//
+// front-ends run on threads in order of command line, so main thread can
+// evaluate first script while others are still being checked.
+//
+static void run_scripts(StringVector const& paths, CmdLineArguments const& cmd) {
+  using namespace fire;
+
+  vector<std::unique_ptr<Script>> scripts;
+
+  for (auto&& path : paths)
+    scripts.emplace_back(std::make_unique<Script>(path));
+
+  std::atomic<size_t> next = 0;
+  std::atomic<bool> cancel = false;
+
+  auto run = [&] {
+    for (size_t i; !cancel && (i = next++) < scripts.size();) {
+      front_end(*scripts[i], cmd);
+
+      scripts[i]->objects = gc::detach_thread();
+      scripts[i]->ready.set_value();
+    }
+
+    alloc::release_thread();
+  };
+
+  vector<std::thread> threads;
+
+  if (scripts.size() == 1)
+    front_end(*scripts[0], cmd);
+  else {
+    size_t count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                    scripts.size());
+
+    for (size_t i = 0; i < count; i++)
+      threads.emplace_back(run);
+  }
+
+  auto join = [&threads] {
+    for (auto&& t : threads)
+      t.join();
+  };
+
+  for (auto&& script : scripts) {
+    if (!threads.empty())
+      script->ready.get_future().wait();
+
+    if (!execute_script(*script)) {
+      cancel = true;
+      join();
+
+      Error::fatal_error("cannot open file '" + script->source.path + "'");
+    }
+
+    script.reset();
+  }
+
+  join();
 }
 
 int main(int argc, char** argv) {
@@ -114,9 +369,15 @@ int main(int argc, char** argv) {
     fire::Error::fatal_error("no input files.");
   }
 
-  for (auto&& path : args.sources) {
-    execute_file(path);
+  run_scripts(args.sources, args);
+
+  if (fire::gc::get_config().print_stats) {
+    fire::gc::collect();
+    fire::gc::print_stats();
   }
 
+  if (args.alloc_stats)
+    fire::alloc::print_stats();
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#
+# generates large scripts for benchmarks into test/bench/gen.
+#
+#  usage: python3 test/bench/gen.py
+#         test/run.sh ./fire test/bench test/bench/gen
+#
+#  comments43m  43 MB of comments               (lexer, source mapping)
+#  decl20k      20k lines of declarations       (source locations, parser)
+#               180k tokens, see --parse-stats
+#  sema4k       4000 functions and globals      (name lookup, --jobs)
+#  tmpl5k       5000 lines of template calls    (template instances)
+#
+#  bench1.fire (loop of evaluator) is not generated.
+#
+
+import os
+
+OUTDIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "gen")
+
+def write(name: str, lines: list[str], out: str):
+    with open(f"{OUTDIR}/{name}.fire", mode="w") as fs:
+        fs.write("\n".join(lines) + "\n")
+
+    with open(f"{OUTDIR}/{name}.out", mode="w") as fs:
+        fs.write(out)
+
+    print(f"{OUTDIR}/{name}.fire")
+
+def comments43m():
+    lines = [ f"// generated configuration line number {i} padding padding"
+              for i in range(700000) ]
+
+    lines.append("println(1);")
+
+    write("comments43m", lines, "1\n")
+
+def decl20k():
+    lines = [ f"let v{i} = {i} + {i} * 2;" for i in range(20000) ]
+
+    lines.append("println(v19999);")
+
+    write("decl20k", lines, f"{19999 * 3}\n")
+
+def sema4k():
+    lines = [ ]
+
+    # f(i) calls f(i - 1), and every 50th returns. all of them are checked
+    # on threads with --jobs.
+    for i in range(4000):
+        ret = "y - x" if i % 50 == 0 else f"f{i - 1}(y - x)"
+
+        lines += [ f"fn f{i}(a: int) -> int {{",
+                   f"  let x = a + {i % 7};",
+                   "  let y = x * 2;",
+                   f"  return {ret};",
+                   "}" ]
+
+    lines += [ f"let g{i} = {i} + 1;" for i in range(4000) ]
+
+    lines.append("println(f3999(1));")
+
+    # each function adds (i % 7) to argument
+    x = 1
+
+    for i in range(3950, 4000):
+        x += i % 7
+
+    write("sema4k", lines, f"{x}\n")
+
+def tmpl5k():
+    lines = [ "fn pick<T>(a: T, b: T) -> int {",
+              "  let x: T = a;",
+              "  return 1;",
+              "}",
+              "",
+              "fn twice<T>(a: T) -> int {",
+              "  let y = pick(a, a);",
+              "  return 2;",
+              "}",
+              "",
+              "fn main() {",
+              "  let s = 0;" ]
+
+    for i in range(5000):
+        lines.append(f"  s = s + twice({i}) + pick({i}, 1) + twice(\"{i}\")"
+                     f" + twice(1.5) + twice([{i}]);")
+
+    lines += [ "  println(s);",
+               "}",
+               "",
+               "main();" ]
+
+    write("tmpl5k", lines, f"{5000 * 9}\n")
+
+def __main__():
+    os.makedirs(OUTDIR, exist_ok=True)
+
+    comments43m()
+    decl20k()
+    sema4k()
+    tmpl5k()
+
+if __name__ == "__main__":
+    __main__()
@@ -0,0 +1,149 @@
+#!/bin/bash
+#
+# regression tests
+#
+#  usage: test/run.sh [fired] [dir ...]     (default: ./fired test)
+#
+#  <name>.fire is run if <name>.out or <name>.err exists.
+#    <name>.out  expected stdout (empty if not exists)
+#    <name>.err  lines of expected error. (errors are printed to stdout, so
+#                stdout must start with .out, and then contain these lines)
+#
+#  stderr must be empty, except the lines of .err.
+#
+#  first line "// args: ..." of script gives more command line arguments.
+#
+#  each script runs twice with new cache directory: compiled, and loaded from
+#  cache. after that, all scripts of a directory without args and .err run in
+#  one invocation, and stdout must be .out of them in order.
+#
+
+fired=$(realpath "${1:-./fired}")
+shift
+
+cd "$(dirname "$0")/.." || exit 1
+
+dirs=("${@:-test}")
+
+export XDG_CACHE_HOME=$(mktemp -d)
+tmp=$(mktemp -d)
+
+trap 'rm -rf "$XDG_CACHE_HOME" "$tmp"' EXIT
+
+passed=0
+failed=0
+
+strip_color() {
+  sed 's/\x1b\[[0-9;]*m//g'
+}
+
+# check <name> <expected stdout> <.err file or empty>
+check() {
+  local name=$1 expected=$2 err=$3
+
+  if [ -z "$err" ]; then
+    if ! diff -u "$expected" "$tmp/out" > "$tmp/diff"; then
+      echo "FAIL $name: stdout differs"
+      cat "$tmp/diff"
+      return 1
+    fi
+
+    if [ -s "$tmp/err" ]; then
+      echo "FAIL $name: unexpected stderr"
+      cat "$tmp/err"
+      return 1
+    fi
+
+    return 0
+  fi
+
+  if ! head -c "$(wc -c < "$expected")" "$tmp/out" | cmp -s - "$expected"; then
+    echo "FAIL $name: stdout doesn't start with $expected"
+    cat "$tmp/out"
+    return 1
+  fi
+
+  strip_color < "$tmp/out" >> "$tmp/err"
+
+  while IFS= read -r line; do
+    if ! grep -qF -- "$line" "$tmp/err"; then
+      echo "FAIL $name: error doesn't contain '$line'"
+      cat "$tmp/err"
+      return 1
+    fi
+  done < "$err"
+}
+
+# run <script> <args...>, and prints seconds
+run() {
+  local begin=$EPOCHREALTIME
+
+  "$fired" "$@" > "$tmp/out" 2> "$tmp/err.raw" < /dev/null
+  strip_color < "$tmp/err.raw" > "$tmp/err"
+
+  awk "BEGIN { printf \"%.2f\", $EPOCHREALTIME - $begin }"
+}
+
+for dir in "${dirs[@]}"; do
+  together=()
+  expected_all=()
+
+  for src in "$dir"/*.fire; do
+    base=${src%.fire}
+    name=${base#test/}
+
+    [ -f "$base.out" ] || [ -f "$base.err" ] || continue
+
+    expected=/dev/null
+    [ -f "$base.out" ] && expected=$base.out
+
+    err=
+    [ -f "$base.err" ] && err=$base.err
+
+    args=()
+    if read -r first < "$src" && [[ $first == "// args: "* ]]; then
+      read -ra args <<< "${first#// args: }"
+    fi
+
+    ok=1
+    times=()
+
+    for mode in cold cached; do
+      times+=("$mode $(run "$src" "${args[@]}")s")
+
+      if ! check "$name ($mode)" "$expected" "$err"; then
+        ok=0
+        break
+      fi
+    done
+
+    if [ $ok = 1 ]; then
+      echo "ok   $name (${times[0]}, ${times[1]})"
+      passed=$((passed + 1))
+    else
+      failed=$((failed + 1))
+    fi
+
+    if [ ${#args[@]} = 0 ] && [ -z "$err" ]; then
+      together+=("$src")
+      expected_all+=("$expected")
+    fi
+  done
+
+  if [ ${#together[@]} -ge 2 ]; then
+    cat "${expected_all[@]}" > "$tmp/expected"
+
+    time=$(run "${together[@]}")
+
+    if check "$dir (${#together[@]} scripts together)" "$tmp/expected" ""; then
+      echo "ok   $dir: ${#together[@]} scripts together (${time}s)"
+      passed=$((passed + 1))
+    else
+      failed=$((failed + 1))
+    fi
+  fi
+done
+
+echo "$passed passed, $failed failed"
+
+[ $failed = 0 ]